@@ -1,26 +1,197 @@
 #include "attacks.h"
 #include "bitutils.h"
 #include "rays.h"
-#include <cstring>
 
-U64 Attacks::detail::_nonSlidingAttacks[2][6][64] = {{{0}}};
+#ifdef ATTACKS_PEXT
+#include <immintrin.h>
+#endif
 
-U64 Attacks::detail::_rookMasks[64] = {0};
-U64 Attacks::detail::_bishopMasks[64] = {0};
+namespace {
+using Attacks::detail::SquareTable;
+using Attacks::detail::SlidingTable;
+using Rays::detail::RayTable;
 
-U64 Attacks::detail::_rookTable[64][4096] = {{0}};
-U64 Attacks::detail::_bishopTable[64][1024] = {{0}};
+constexpr Table<Table<SquareTable, 6>, 2> makeNonSlidingAttacks() {
+  Table<Table<SquareTable, 6>, 2> attacks{};
 
-void Attacks::init() {
-  detail::_initPawnAttacks();
-  detail::_initKnightAttacks();
-  detail::_initKingAttacks();
+  for (int i = 0; i < 64; i++) {
+    U64 start = ONE << i;
+
+    // Pawns
+    attacks[WHITE][PAWN][i] = ((start << 9) & ~FILE_A) | ((start << 7) & ~FILE_H);
+    attacks[BLACK][PAWN][i] = ((start >> 9) & ~FILE_H) | ((start >> 7) & ~FILE_A);
+
+    // Knights
+    U64 knightAttacks = (((start << 15) | (start >> 17)) & ~FILE_H) | // Left 1
+        (((start >> 15) | (start << 17)) & ~FILE_A) | // Right 1
+        (((start << 6) | (start >> 10)) & ~(FILE_G | FILE_H)) | // Left 2
+        (((start >> 6) | (start << 10)) & ~(FILE_A | FILE_B)); // Right 2
+    attacks[WHITE][KNIGHT][i] = knightAttacks;
+    attacks[BLACK][KNIGHT][i] = knightAttacks;
+
+    // Kings
+    U64 kingAttacks = (((start << 7) | (start >> 9) | (start >> 1)) & (~FILE_H)) |
+        (((start << 9) | (start >> 7) | (start << 1)) & (~FILE_A)) |
+        ((start >> 8) | (start << 8));
+    attacks[WHITE][KING][i] = kingAttacks;
+    attacks[BLACK][KING][i] = kingAttacks;
+  }
+
+  return attacks;
+}
+
+constexpr U64 rookMask(const RayTable &rays, int square) {
+  return (rays[Rays::NORTH][square] & ~RANK_8) |
+      (rays[Rays::SOUTH][square] & ~RANK_1) |
+      (rays[Rays::EAST][square] & ~FILE_H) |
+      (rays[Rays::WEST][square] & ~FILE_A);
+}
+
+constexpr U64 bishopMask(const RayTable &rays, int square) {
+  return (rays[Rays::NORTH_EAST][square] | rays[Rays::NORTH_WEST][square] |
+      rays[Rays::SOUTH_WEST][square] | rays[Rays::SOUTH_EAST][square]) & ~(FILE_A | FILE_H | RANK_1 | RANK_8);
+}
+
+constexpr SquareTable makeMasks(bool rook) {
+  RayTable rays = Rays::detail::_makeRays();
+  SquareTable masks{};
+
+  for (int square = 0; square < 64; square++) {
+    masks[square] = rook ? rookMask(rays, square) : bishopMask(rays, square);
+  }
+
+  return masks;
+}
+
+constexpr Table<int, 64> makeOffsets(bool rook) {
+  Table<int, 64> offsets{};
+
+  // Bishop attacks are stored after all rook attacks
+  int offset = 0;
+  if (!rook) {
+    for (int square = 0; square < 64; square++) {
+      offset += 1 << Attacks::detail::_rookIndexBits[square];
+    }
+  }
+
+  for (int square = 0; square < 64; square++) {
+    offsets[square] = offset;
+    offset += 1 << (rook ? Attacks::detail::_rookIndexBits[square] : Attacks::detail::_bishopIndexBits[square]);
+  }
+
+  return offsets;
+}
+
+/**
+ * @brief Returns the attacks along the given ray (indexed by [square]) up to
+ * and including the first blocker.
+ *
+ * forward must be true if the ray goes towards higher square indexes.
+ */
+constexpr U64 rayAttacks(const U64 *ray, bool forward, int square, U64 blockers) {
+  U64 attacks = ray[square];
+  U64 blocked = attacks & blockers;
+  if (blocked) {
+    attacks &= ~ray[forward ? _bitscanForward(blocked) : _bitscanReverse(blocked)];
+  }
+  return attacks;
+}
+
+/**
+ * @brief Builds the packed sliding attack table, indexed either by PEXT or by
+ * magics.
+ */
+constexpr SlidingTable makeSlidingTable(bool pext) {
+  using namespace Attacks::detail;
+
+  RayTable rays = Rays::detail::_makeRays();
+  SlidingTable table{};
+  int offset = 0;
+
+  // Rooks first, then bishops
+  for (int piece = 0; piece < 2; piece++) {
+    bool rook = piece == 0;
+
+    // Rays in the directions this piece moves in, and whether they go towards
+    // higher square indexes
+    const U64 *pieceRays[4] = {
+        rays[rook ? Rays::NORTH : Rays::NORTH_EAST].values,
+        rays[rook ? Rays::SOUTH : Rays::NORTH_WEST].values,
+        rays[rook ? Rays::EAST : Rays::SOUTH_EAST].values,
+        rays[rook ? Rays::WEST : Rays::SOUTH_WEST].values
+    };
+    const bool forward[4] = {true, !rook, rook, false};
+
+    for (int square = 0; square < 64; square++) {
+      U64 mask = rook ? rookMask(rays, square) : bishopMask(rays, square);
+      U64 magic = rook ? _rookMagics[square] : _bishopMagics[square];
+      int bits = rook ? _rookIndexBits[square] : _bishopIndexBits[square];
+
+      // Enumerate all subsets of the mask (carry-rippler), which visits them
+      // in the order of their PEXT indexes
+      U64 blockers = ZERO;
+      U64 pextIndex = 0;
+      do {
+        U64 index = pext ? pextIndex : (blockers * magic) >> (64 - bits);
+        table.values[offset + index] = rayAttacks(pieceRays[0], forward[0], square, blockers) |
+            rayAttacks(pieceRays[1], forward[1], square, blockers) |
+            rayAttacks(pieceRays[2], forward[2], square, blockers) |
+            rayAttacks(pieceRays[3], forward[3], square, blockers);
+
+        pextIndex++;
+        blockers = (blockers - mask) & mask;
+      } while (blockers);
+
+      offset += 1 << bits;
+    }
+  }
+
+  return table;
+}
+}
+
+constexpr Table<Table<SquareTable, 6>, 2> Attacks::detail::_nonSlidingAttacks = makeNonSlidingAttacks();
+
+constexpr SquareTable Attacks::detail::_rookMasks = makeMasks(true);
+constexpr SquareTable Attacks::detail::_bishopMasks = makeMasks(false);
+
+constexpr Table<int, 64> Attacks::detail::_rookOffsets = makeOffsets(true);
+constexpr Table<int, 64> Attacks::detail::_bishopOffsets = makeOffsets(false);
+
+#ifdef ATTACKS_MAGIC
+constexpr SlidingTable Attacks::detail::_magicSlidingTable = makeSlidingTable(false);
+#endif
+#ifdef ATTACKS_PEXT
+constexpr SlidingTable Attacks::detail::_pextSlidingTable = makeSlidingTable(true);
+#endif
 
-  detail::_initRookMasks();
-  detail::_initBishopMasks();
+#if defined(ATTACKS_PEXT) && defined(ATTACKS_MAGIC)
+bool Attacks::detail::_usePext = false;
 
-  detail::_initRookMagicTable();
-  detail::_initBishopMagicTable();
+// Compiled for BMI2 regardless of the target architecture so it can be used
+// if CPUID reports BMI2 support at runtime
+__attribute__((target("bmi2")))
+U64 Attacks::detail::_pext(U64 src, U64 mask) {
+  return _pext_u64(src, mask);
+}
+
+bool Attacks::detail::_pextSupported() {
+  return __builtin_cpu_supports("bmi2");
+}
+#elif defined(ATTACKS_PEXT)
+bool Attacks::detail::_pextSupported() {
+  return true;
+}
+#else
+bool Attacks::detail::_pextSupported() {
+  return false;
+}
+#endif
+
+void Attacks::init() {
+#if defined(ATTACKS_PEXT) && defined(ATTACKS_MAGIC)
+  detail::_usePext = detail::_pextSupported();
+#endif
 }
 
 U64 Attacks::detail::_getBlockersFromIndex(int index, U64 mask) {
@@ -35,57 +206,49 @@ U64 Attacks::detail::_getBlockersFromIndex(int index, U64 mask) {
   return blockers;
 }
 
-void Attacks::detail::_initRookMasks() {
-  for (int square = 0; square < 64; square++) {
-    _rookMasks[square] = (Rays::getRay(Rays::NORTH, square) & ~RANK_8) |
-        (Rays::getRay(Rays::SOUTH, square) & ~RANK_1) |
-        (Rays::getRay(Rays::EAST, square) & ~FILE_H) |
-        (Rays::getRay(Rays::WEST, square) & ~FILE_A);
-  }
+U64 Attacks::detail::_getBishopAttacks(int square, U64 blockers) {
+#if defined(ATTACKS_PEXT) && defined(ATTACKS_MAGIC)
+  return _usePext ? _getBishopAttacksPext(square, blockers) : _getBishopAttacksMagic(square, blockers);
+#elif defined(ATTACKS_PEXT)
+  return _getBishopAttacksPext(square, blockers);
+#else
+  return _getBishopAttacksMagic(square, blockers);
+#endif
 }
 
-void Attacks::detail::_initBishopMasks() {
-  U64 edgeSquares = FILE_A | FILE_H | RANK_1 | RANK_8;
-  for (int square = 0; square < 64; square++) {
-    _bishopMasks[square] = (Rays::getRay(Rays::NORTH_EAST, square) | Rays::getRay(Rays::NORTH_WEST, square) |
-        Rays::getRay(Rays::SOUTH_WEST, square) | Rays::getRay(Rays::SOUTH_EAST, square)) & ~(edgeSquares);
-  }
+U64 Attacks::detail::_getRookAttacks(int square, U64 blockers) {
+#if defined(ATTACKS_PEXT) && defined(ATTACKS_MAGIC)
+  return _usePext ? _getRookAttacksPext(square, blockers) : _getRookAttacksMagic(square, blockers);
+#elif defined(ATTACKS_PEXT)
+  return _getRookAttacksPext(square, blockers);
+#else
+  return _getRookAttacksMagic(square, blockers);
+#endif
 }
 
-void Attacks::detail::_initRookMagicTable() {
-  // For all squares
-  for (int square = 0; square < 64; square++) {
-    // For all possible blockers for this square
-    for (int blockerIndex = 0; blockerIndex < (1 << _rookIndexBits[square]); blockerIndex++) {
-      U64 blockers = _getBlockersFromIndex(blockerIndex, _rookMasks[square]);
-      _rookTable[square][(blockers * _rookMagics[square]) >> (64 - _rookIndexBits[square])] =
-          _getRookAttacksSlow(square, blockers);
-    }
-  }
+#ifdef ATTACKS_PEXT
+U64 Attacks::detail::_getBishopAttacksPext(int square, U64 blockers) {
+  return _pextSlidingTable[_bishopOffsets[square] + _pext(blockers, _bishopMasks[square])];
 }
 
-void Attacks::detail::_initBishopMagicTable() {
-  // For all squares
-  for (int square = 0; square < 64; square++) {
-    // For all possible blockers for this square
-    for (int blockerIndex = 0; blockerIndex < (1 << _bishopIndexBits[square]); blockerIndex++) {
-      U64 blockers = _getBlockersFromIndex(blockerIndex, _bishopMasks[square]);
-      _bishopTable[square][(blockers * _bishopMagics[square]) >> (64 - _bishopIndexBits[square])] =
-          _getBishopAttacksSlow(square, blockers);
-    }
-  }
+U64 Attacks::detail::_getRookAttacksPext(int square, U64 blockers) {
+  return _pextSlidingTable[_rookOffsets[square] + _pext(blockers, _rookMasks[square])];
 }
+#endif
 
-U64 Attacks::detail::_getBishopAttacks(int square, U64 blockers) {
+#ifdef ATTACKS_MAGIC
+U64 Attacks::detail::_getBishopAttacksMagic(int square, U64 blockers) {
   blockers &= _bishopMasks[square];
-  return detail::_bishopTable[square][(blockers * detail::_bishopMagics[square]) >> (64 - detail::_bishopIndexBits[square])];
+  return _magicSlidingTable[_bishopOffsets[square] +
+      ((blockers * _bishopMagics[square]) >> (64 - _bishopIndexBits[square]))];
 }
 
-U64 Attacks::detail::_getRookAttacks(int square, U64 blockers) {
-  blockers &= detail::_rookMasks[square];
-  U64 key = (blockers * detail::_rookMagics[square]) >> (64 - detail::_rookIndexBits[square]);
-  return detail::_rookTable[square][key];
+U64 Attacks::detail::_getRookAttacksMagic(int square, U64 blockers) {
+  blockers &= _rookMasks[square];
+  return _magicSlidingTable[_rookOffsets[square] +
+      ((blockers * _rookMagics[square]) >> (64 - _rookIndexBits[square]))];
 }
+#endif
 
 U64 Attacks::getNonSlidingAttacks(PieceType pieceType, int square, Color color) {
   return detail::_nonSlidingAttacks[color][pieceType][square];
@@ -161,42 +324,3 @@ U64 Attacks::detail::_getRookAttacksSlow(int square, U64 blockers) {
 
   return attacks;
 }
-
-void Attacks::detail::_initPawnAttacks() {
-  for (int i = 0; i < 64; i++) {
-    U64 start = ONE << i;
-
-    U64 whiteAttackBb = ((start << 9) & ~FILE_A) | ((start << 7) & ~FILE_H);
-    U64 blackAttackBb = ((start >> 9) & ~FILE_H) | ((start >> 7) & ~FILE_A);
-
-    _nonSlidingAttacks[WHITE][PAWN][i] = whiteAttackBb;
-    _nonSlidingAttacks[BLACK][PAWN][i] = blackAttackBb;
-  }
-}
-
-void Attacks::detail::_initKnightAttacks() {
-  for (int i = 0; i < 64; i++) {
-    U64 start = ONE << i;
-
-    U64 attackBb = (((start << 15) | (start >> 17)) & ~FILE_H) | // Left 1
-        (((start >> 15) | (start << 17)) & ~FILE_A) | // Right 1
-        (((start << 6) | (start >> 10)) & ~(FILE_G | FILE_H)) | // Left 2
-        (((start >> 6) | (start << 10)) & ~(FILE_A | FILE_B)); // Right 2
-
-    _nonSlidingAttacks[WHITE][KNIGHT][i] = attackBb;
-    _nonSlidingAttacks[BLACK][KNIGHT][i] = attackBb;
-  }
-}
-
-void Attacks::detail::_initKingAttacks() {
-  for (int i = 0; i < 64; i++) {
-    U64 start = ONE << i;
-
-    U64 attackBb = (((start << 7) | (start >> 9) | (start >> 1)) & (~FILE_H)) |
-        (((start << 9) | (start >> 7) | (start << 1)) & (~FILE_A)) |
-        ((start >> 8) | (start << 8));
-
-    _nonSlidingAttacks[WHITE][KING][i] = attackBb;
-    _nonSlidingAttacks[BLACK][KING][i] = attackBb;
-  }
-}
@@ -2,32 +2,44 @@
 #define ATTACKS_H
 
 #include "defs.h"
+#include "table.h"
 
 /**
- * @brief Namespace containing attack bitboard generation utilities
- */
-namespace Attacks {
-namespace detail {
-/**
- * @name Non sliding attack initialization functions
- * @brief These functions precalculate pawn, knight and king moves for
- * each square
+ * @name Sliding attack lookup backends
+ * @brief Defined for each backend compiled in
+ *
+ * Builds with BMI2 support (and without NO_PEXT) only include PEXT lookups,
+ * and builds that can never use PEXT (NO_PEXT or not x86) only include magic
+ * lookups. Other builds include both and choose one at runtime in init().
+ * Each backend has its own ~840KB attack table, so only building the
+ * backends that may be used keeps the binary small.
  *
  * @{
  */
-void _initPawnAttacks();
-void _initKnightAttacks();
-void _initKingAttacks();
+#if defined(__BMI2__) && !defined(NO_PEXT)
+#define ATTACKS_PEXT
+#include <immintrin.h>
+#elif defined(NO_PEXT) || !defined(__GNUC__) || !(defined(__x86_64__) || defined(__i386__))
+#define ATTACKS_MAGIC
+#else
+#define ATTACKS_PEXT
+#define ATTACKS_MAGIC
+#endif
 /**@}*/
 
+/**
+ * @brief Namespace containing attack bitboard generation utilities
+ */
+namespace Attacks {
+namespace detail {
 /**
  * @name Rook/Bishop attack precalculation functions
  * @brief These functions calculate rook and bishop attacks for the given
  * square and the given set of blockers
  *
- * Note that these functions should only be used for precalculating attack
- * bitboards to put in magic tables. The much faster _getRookAttacks and
- * _getBishopAttacks should be used in all other scenarios.
+ * Note that these functions should only be used for testing. The much
+ * faster _getRookAttacks and _getBishopAttacks should be used in all other
+ * scenarios.
  *
  * @{
  */
@@ -36,50 +48,90 @@ U64 _getBishopAttacksSlow(int, U64);
 /**@}*/
 
 /**
- * @name Rook/bishop magic table precalculation functions
+ * @name Rook/Bishop attack bitboard generation functions
+ * @brief Gets rook/bishop attacks on the given square with the given blocker
+ * pieces
  *
- * Initializes the internal rook/bishop magic tables used for
- * fast calculation of sliding attacks
+ * These functions look up attacks using PEXT if _usePext is set, otherwise
+ * they use magics.
  *
  * @{
  */
-void _initRookMagicTable();
-void _initBishopMagicTable();
+U64 _getRookAttacks(int, U64);
+U64 _getBishopAttacks(int, U64);
 /**@}*/
 
 /**
- * @name Rook/bishop mask precalculation functions
+ * @name Magic rook/bishop attack bitboard generation functions
+ * @brief Gets rook/bishop attacks on the given square with the given blocker
+ * pieces using the fancy magic bitboard technique
  *
- * Initializes the internal tables of rook/bishop masks used for
- * sliding attack calculations
+ * These are only available if ATTACKS_MAGIC is defined.
  *
  * @{
  */
-void _initRookMasks();
-void _initBishopMasks();
+#ifdef ATTACKS_MAGIC
+U64 _getRookAttacksMagic(int, U64);
+U64 _getBishopAttacksMagic(int, U64);
+#endif
 /**@}*/
 
 /**
- * @name Rook/Bishop attack bitboard generation functions
+ * @name PEXT rook/bishop attack bitboard generation functions
  * @brief Gets rook/bishop attacks on the given square with the given blocker
- * pieces
+ * pieces, using the BMI2 PEXT instruction to index the attack tables
  *
- * Internally these functions use the fancy magic bitboard technique to lookup
- * attacks from a preinitialized attack table
+ * These are only available if ATTACKS_PEXT is defined, and must only be
+ * called if _pextSupported() returns true.
  *
  * @{
  */
-U64 _getRookAttacks(int, U64);
-U64 _getBishopAttacks(int, U64);
+#ifdef ATTACKS_PEXT
+U64 _getRookAttacksPext(int, U64);
+U64 _getBishopAttacksPext(int, U64);
+#endif
 /**@}*/
 
+/**
+ * @brief Returns true if PEXT can be used on this CPU.
+ *
+ * If Shallow Blue was compiled with BMI2 support (eg. using -mbmi2 or
+ * -march=native on a CPU supporting BMI2), this is always true. Otherwise
+ * CPUID is queried at runtime (on x86 only).
+ *
+ * Define NO_PEXT when compiling to never use PEXT (PEXT is very slow on some
+ * CPUs that support it, such as AMD CPUs before Zen 3).
+ *
+ * @return true if PEXT can be used on this CPU, false otherwise
+ */
+bool _pextSupported();
+
+/**
+ * @brief Returns the bits of src selected by mask, packed into the low bits
+ * of the result (using the BMI2 PEXT instruction).
+ *
+ * This is only available if ATTACKS_PEXT is defined.
+ *
+ * @param src Value to extract bits from
+ * @param mask Bits to extract
+ * @return The bits of src selected by mask, in order, from bit 0 upwards
+ */
+#if defined(ATTACKS_PEXT) && !defined(ATTACKS_MAGIC)
+inline U64 _pext(U64 src, U64 mask) {
+  return _pext_u64(src, mask);
+}
+#elif defined(ATTACKS_PEXT)
+U64 _pext(U64, U64);
+#endif
+
 /**
  * @brief Given a blockers bitboard and an index value containing
  * no more set bits than exist in the blockers bitboard, return a new bitboard
  * with blocked squares bits set or unset in the same order as in the passed
  * index
  *
- * This is used to exhaustively generate blocker sets to create magic tables.
+ * This is used to exhaustively generate blocker sets to test sliding attack
+ * lookups.
  *
  * @return A bitboard with the blocked bits set/unset in the same order as
  * the index
@@ -87,20 +139,75 @@ U64 _getBishopAttacks(int, U64);
 U64 _getBlockersFromIndex(int, U64);
 
 /**
- * @brief 3D array indexed by [color][pieceType][square] of non sliding
+ * @brief Table of bitboards indexed by [square]
+ */
+typedef Table<U64, 64> SquareTable;
+
+/**
+ * @brief 3D table indexed by [color][pieceType][square] of non sliding
  * piece attacks
  */
-extern U64 _nonSlidingAttacks[2][6][64];
+extern const Table<Table<SquareTable, 6>, 2> _nonSlidingAttacks;
+
+/**
+ * @brief Number of entries in the sliding attack table.
+ *
+ * This is the sum of 2^(number of bits in the mask) over all squares for rooks
+ * (102400) and bishops (5248).
+ */
+const int _SLIDING_TABLE_SIZE = 107648;
+
+/**
+ * @brief Packed table of rook and bishop attacks for every blocker set
+ */
+typedef Table<U64, _SLIDING_TABLE_SIZE> SlidingTable;
+
+/**
+ * @name Packed sliding attack tables for magic and PEXT lookups
+ *
+ * Each square uses only as many entries as it has blocker sets, starting at
+ * the square's offset in _rookOffsets or _bishopOffsets. Packing the tables
+ * like this (as opposed to reserving the maximum size for every square)
+ * keeps them small enough (about 840KB each) to stay mostly in cache.
+ *
+ * The two tables hold the same attacks in a different order. Only the tables
+ * of the backends compiled in (see ATTACKS_PEXT and ATTACKS_MAGIC) exist.
+ *
+ * @{
+ */
+#ifdef ATTACKS_MAGIC
+extern const SlidingTable _magicSlidingTable;
+#endif
+#ifdef ATTACKS_PEXT
+extern const SlidingTable _pextSlidingTable;
+#endif
+/**@}*/
 
 /**
- * @name Rook and bishop magic bitboard tables
+ * @name Offsets of each square's attacks in the sliding attack tables
+ * indexed by [square]
  *
  * @{
  */
-extern U64 _rookTable[64][4096];
-extern U64 _bishopTable[64][1024];
+extern const Table<int, 64> _rookOffsets;
+extern const Table<int, 64> _bishopOffsets;
 /**@}*/
 
+/**
+ * @brief True if PEXT is used for sliding attack lookups, false if magics
+ * are used.
+ *
+ * This is a compile time constant if only one backend is compiled in, and is
+ * otherwise set by init() based on _pextSupported().
+ */
+#if defined(ATTACKS_PEXT) && defined(ATTACKS_MAGIC)
+extern bool _usePext;
+#elif defined(ATTACKS_PEXT)
+const bool _usePext = true;
+#else
+const bool _usePext = false;
+#endif
+
 /**
  * @name Rook and bishop sliding attack masks indexed by [square]
  *
@@ -108,8 +215,8 @@ extern U64 _bishopTable[64][1024];
  *
  * @{
  */
-extern U64 _rookMasks[64];
-extern U64 _bishopMasks[64];
+extern const SquareTable _rookMasks;
+extern const SquareTable _bishopMasks;
 /**@}*/
 
 /**
@@ -183,7 +290,10 @@ const int _bishopIndexBits[64] = {
 }
 
 /**
- * @brief Initializes all internal values used to generate attacks
+ * @brief Selects the sliding attack lookup backend (PEXT or magics)
+ *
+ * All attack tables are calculated at compile time, so this only needs to
+ * check if PEXT is supported by the CPU.
  */
 void init();
 
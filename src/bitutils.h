@@ -13,7 +13,7 @@
  * @param  board Value to reset LSB of
  * @return Index of reset LSB
  */
-inline int _popLsb(U64 &board) {
+constexpr int _popLsb(U64 &board) {
   int lsbIndex = __builtin_ffsll(board) - 1;
   board &= board - 1;
   return lsbIndex;
@@ -25,7 +25,7 @@ inline int _popLsb(U64 &board) {
  * @param  board Value to return number of set bits for
  * @return Number of set bits in value
  */
-inline int _popCount(U64 board) {
+constexpr int _popCount(U64 board) {
   return __builtin_popcountll(board);
 }
 
@@ -36,7 +36,7 @@ inline int _popCount(U64 board) {
  * @param  board Bitboard to get LSB of
  * @return The index of the LSB in the given bitboard.
  */
-inline int _bitscanForward(U64 board) {
+constexpr int _bitscanForward(U64 board) {
   if (board == ZERO) {
     return -1;
   }
@@ -50,7 +50,7 @@ inline int _bitscanForward(U64 board) {
  * @param  board Bitboard to get MSB of
  * @return The index of the MSB in the given bitboard.
  */
-inline int _bitscanReverse(U64 board) {
+constexpr int _bitscanReverse(U64 board) {
   if (board == ZERO) {
     return -1;
   }
@@ -65,7 +65,7 @@ inline int _bitscanReverse(U64 board) {
 * @param n Number of squares to move east
 * @return A bitboard with all set bits moved one square east, bits falling off the edge discarded
 */
-inline U64 _eastN(U64 board, int n) {
+constexpr U64 _eastN(U64 board, int n) {
   U64 newBoard = board;
   for (int i = 0; i < n; i++) {
     newBoard = ((newBoard << 1) & (~FILE_A));
@@ -82,7 +82,7 @@ inline U64 _eastN(U64 board, int n) {
  * @param n Number of squares to move west
  * @return A bitboard with all set bits moved one square west, bits falling off the edge discarded
  */
-inline U64 _westN(U64 board, int n) {
+constexpr U64 _westN(U64 board, int n) {
   U64 newBoard = board;
   for (int i = 0; i < n; i++) {
     newBoard = ((newBoard >> 1) & (~FILE_H));
@@ -97,7 +97,7 @@ inline U64 _westN(U64 board, int n) {
  * @param square A square in little endian rank file mapping form
  * @return The zero indexed row of the square
  */
-inline int _row(int square) {
+constexpr int _row(int square) {
   return square / 8;
 }
 
@@ -107,7 +107,7 @@ inline int _row(int square) {
  * @param square A square in little endian rank file mapping form
  * @return The zero indexed row of the squares
  */
-inline int _col(int square) {
+constexpr int _col(int square) {
   return square % 8;
 }
 
@@ -1,8 +1,36 @@
 #include "board.h"
 #include "bitutils.h"
 #include "attacks.h"
+#include "eval.h"
+#include <algorithm>
 #include <sstream>
 
+namespace {
+/**
+ * @brief Piece types in order of increasing value, the order in which pieces
+ * recapture in a static exchange evaluation.
+ */
+const PieceType SEE_ATTACKER_ORDER[6] = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
+
+/**
+ * @brief Value of a king in a static exchange evaluation.
+ *
+ * This is large enough that a king will never capture onto a square that is
+ * still defended.
+ */
+const int SEE_KING_VALUE = 20000;
+
+/**
+ * @brief Maximum number of captures in an exchange (there can be at most 32
+ * pieces attacking a square).
+ */
+const int SEE_MAX_CAPTURES = 32;
+
+inline int seeValue(PieceType pieceType) {
+  return pieceType == KING ? SEE_KING_VALUE : Eval::getMaterialValue(pieceType);
+}
+}
+
 Board::Board() {
   setToFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
 }
@@ -79,6 +107,33 @@ ZKey Board::getPawnStructureZKey() const {
   return _pawnStructureZkey;
 }
 
+ZKey Board::getMaterialZKey() const {
+  return _materialZKey;
+}
+
+int Board::getPieceCount(Color color, PieceType pieceType) const {
+  return _pieceCounts[color][pieceType];
+}
+
+Score Board::getMaterial(Color color) const {
+  return _material[color];
+}
+
+int Board::getPhaseWeight() const {
+  return _phaseWeight;
+}
+
+void Board::setAccumulators(Nnue::AccumulatorStack *accumulators) {
+  _accumulators.reset(accumulators);
+  if (_accumulators) {
+    _accumulators->refresh(*this);
+  }
+}
+
+const Nnue::AccumulatorStack *Board::getAccumulators() const {
+  return _accumulators.get();
+}
+
 PSquareTable Board::getPSquareTable() const {
   return _pst;
 }
@@ -313,8 +368,33 @@ void Board::setToFen(std::string fenString) {
   _updateNonPieceBitBoards();
   _zKey = ZKey(*this);
   _pawnStructureZkey.setFromPawnStructure(*this);
+  _updateMaterial();
 
   _pst = PSquareTable(*this);
+
+  if (_accumulators) {
+    _accumulators->refresh(*this);
+  }
+}
+
+void Board::_updateMaterial() {
+  _materialZKey = ZKey();
+  _material[WHITE] = 0;
+  _material[BLACK] = 0;
+  _phaseWeight = 0;
+
+  for (auto color : {WHITE, BLACK}) {
+    for (auto pieceType : {PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING}) {
+      _pieceCounts[color][pieceType] = _popCount(_pieces[color][pieceType]);
+      _material[color] += Eval::MATERIAL_VALUES[pieceType] * _pieceCounts[color][pieceType];
+      _phaseWeight += Eval::detail::PHASE_WEIGHTS[pieceType] * _pieceCounts[color][pieceType];
+
+      // The material key has the key for the nth square set for the nth piece of each type
+      for (int i = 0; i < _pieceCounts[color][pieceType]; i++) {
+        _materialZKey.flipPiece(color, pieceType, i);
+      }
+    }
+  }
 }
 
 void Board::_updateNonPieceBitBoards() {
@@ -363,6 +443,14 @@ void Board::_movePiece(Color color, PieceType pieceType, int from, int to) {
 
   _zKey.movePiece(color, pieceType, from, to);
   _pst.movePiece(color, pieceType, from, to);
+
+  if (_accumulators) {
+    _accumulators->movePiece(color, pieceType, from, to);
+  }
+
+  if (pieceType == PAWN) {
+    _pawnStructureZkey.movePiece(color, PAWN, from, to);
+  }
 }
 
 void Board::_removePiece(Color color, PieceType pieceType, int squareIndex) {
@@ -375,6 +463,18 @@ void Board::_removePiece(Color color, PieceType pieceType, int squareIndex) {
 
   _zKey.flipPiece(color, pieceType, squareIndex);
   _pst.removePiece(color, pieceType, squareIndex);
+
+  if (_accumulators) {
+    _accumulators->removePiece(color, pieceType, squareIndex);
+  }
+
+  _materialZKey.flipPiece(color, pieceType, --_pieceCounts[color][pieceType]);
+  _material[color] -= Eval::MATERIAL_VALUES[pieceType];
+  _phaseWeight -= Eval::detail::PHASE_WEIGHTS[pieceType];
+
+  if (pieceType == PAWN) {
+    _pawnStructureZkey.flipPiece(color, PAWN, squareIndex);
+  }
 }
 
 void Board::_addPiece(Color color, PieceType pieceType, int squareIndex) {
@@ -387,9 +487,32 @@ void Board::_addPiece(Color color, PieceType pieceType, int squareIndex) {
 
   _zKey.flipPiece(color, pieceType, squareIndex);
   _pst.addPiece(color, pieceType, squareIndex);
+
+  if (_accumulators) {
+    _accumulators->addPiece(color, pieceType, squareIndex);
+  }
+
+  _materialZKey.flipPiece(color, pieceType, _pieceCounts[color][pieceType]++);
+  _material[color] += Eval::MATERIAL_VALUES[pieceType];
+  _phaseWeight += Eval::detail::PHASE_WEIGHTS[pieceType];
+
+  if (pieceType == PAWN) {
+    _pawnStructureZkey.flipPiece(color, PAWN, squareIndex);
+  }
 }
 
-void Board::doMove(Move move) {
+UndoInfo Board::doMove(Move move) {
+  UndoInfo undoInfo;
+  undoInfo.enPassant = _enPassant;
+  undoInfo.zKey = _zKey;
+  undoInfo.pawnStructureZKey = _pawnStructureZkey;
+  undoInfo.halfmoveClock = _halfmoveClock;
+  undoInfo.castlingRights = _castlingRights;
+
+  if (_accumulators) {
+    _accumulators->push();
+  }
+
   // Clear En passant info after each move if it exists
   if (_enPassant) {
     _zKey.clearEnPassant();
@@ -475,13 +598,182 @@ void Board::doMove(Move move) {
     _updateCastlingRightsForMove(move);
   }
 
-  // Update pawn structure ZKey if this is a pawn move
-  if (move.getPieceType() == PAWN) {
-    _pawnStructureZkey.movePiece(_activePlayer, PAWN, move.getFrom(), move.getTo());
+  _zKey.flipActivePlayer();
+  _activePlayer = getInactivePlayer();
+
+  return undoInfo;
+}
+
+void Board::undoMove(Move move, const UndoInfo &undoInfo) {
+  // The accumulator from before the move is still on the stack, so pop it
+  // instead of reversing each piece change below
+  Nnue::AccumulatorStack *accumulators = _accumulators.get();
+  if (accumulators) {
+    accumulators->pop();
+    _accumulators.reset();
   }
 
+  _activePlayer = getInactivePlayer();
+
+  // Reverse the piece movements made by doMove()
+  unsigned int flags = move.getFlags();
+  if (!flags || (flags & Move::DOUBLE_PAWN_PUSH)) {
+    _movePiece(_activePlayer, move.getPieceType(), move.getTo(), move.getFrom());
+  } else if ((flags & Move::CAPTURE) && (flags & Move::PROMOTION)) { // Capture promotion special case
+    _removePiece(_activePlayer, move.getPromotionPieceType(), move.getTo());
+    _addPiece(_activePlayer, PAWN, move.getFrom());
+    _addPiece(getInactivePlayer(), move.getCapturedPieceType(), move.getTo());
+  } else if (flags & Move::CAPTURE) {
+    _movePiece(_activePlayer, move.getPieceType(), move.getTo(), move.getFrom());
+    _addPiece(getInactivePlayer(), move.getCapturedPieceType(), move.getTo());
+  } else if (flags & Move::KSIDE_CASTLE) {
+    _movePiece(_activePlayer, KING, move.getTo(), move.getFrom());
+
+    if (_activePlayer == WHITE) {
+      _movePiece(WHITE, ROOK, f1, h1);
+    } else {
+      _movePiece(BLACK, ROOK, f8, h8);
+    }
+  } else if (flags & Move::QSIDE_CASTLE) {
+    _movePiece(_activePlayer, KING, move.getTo(), move.getFrom());
+
+    if (_activePlayer == WHITE) {
+      _movePiece(WHITE, ROOK, d1, a1);
+    } else {
+      _movePiece(BLACK, ROOK, d8, a8);
+    }
+  } else if (flags & Move::EN_PASSANT) {
+    _movePiece(_activePlayer, move.getPieceType(), move.getTo(), move.getFrom());
+
+    if (_activePlayer == WHITE) {
+      _addPiece(BLACK, PAWN, move.getTo() - 8);
+    } else {
+      _addPiece(WHITE, PAWN, move.getTo() + 8);
+    }
+  } else if (flags & Move::PROMOTION) {
+    _removePiece(_activePlayer, move.getPromotionPieceType(), move.getTo());
+    _addPiece(_activePlayer, PAWN, move.getFrom());
+  }
+
+  // Restore irreversible state (this also undoes the key updates made above)
+  _enPassant = undoInfo.enPassant;
+  _zKey = undoInfo.zKey;
+  _pawnStructureZkey = undoInfo.pawnStructureZKey;
+  _halfmoveClock = undoInfo.halfmoveClock;
+  _castlingRights = undoInfo.castlingRights;
+
+  _accumulators.reset(accumulators);
+}
+
+UndoInfo Board::doNullMove() {
+  UndoInfo undoInfo;
+  undoInfo.enPassant = _enPassant;
+  undoInfo.zKey = _zKey;
+  undoInfo.pawnStructureZKey = _pawnStructureZkey;
+  undoInfo.halfmoveClock = _halfmoveClock;
+  undoInfo.castlingRights = _castlingRights;
+
+  if (_enPassant) {
+    _zKey.clearEnPassant();
+    _enPassant = ZERO;
+  }
+
+  _halfmoveClock++;
+
   _zKey.flipActivePlayer();
   _activePlayer = getInactivePlayer();
+
+  return undoInfo;
+}
+
+void Board::undoNullMove(const UndoInfo &undoInfo) {
+  _activePlayer = getInactivePlayer();
+
+  _enPassant = undoInfo.enPassant;
+  _zKey = undoInfo.zKey;
+  _halfmoveClock = undoInfo.halfmoveClock;
+}
+
+int Board::see(Move move) const {
+  int to = move.getTo();
+  U64 fromSquare = ONE << move.getFrom();
+  U64 occupied = _occupied;
+  unsigned int flags = move.getFlags();
+
+  // gains[i] is the material balance for the side making the ith capture if
+  // the exchange stops after that capture
+  int gains[SEE_MAX_CAPTURES];
+  int captures = 0;
+
+  PieceType onSquare = move.getPieceType();
+  if (flags & Move::CAPTURE) {
+    gains[0] = seeValue(move.getCapturedPieceType());
+  } else if (flags & Move::EN_PASSANT) {
+    gains[0] = seeValue(PAWN);
+    occupied ^= ONE << (_activePlayer == WHITE ? to - 8 : to + 8);
+  } else {
+    gains[0] = 0;
+  }
+
+  if (flags & Move::PROMOTION) {
+    onSquare = move.getPromotionPieceType();
+    gains[0] += seeValue(onSquare) - seeValue(PAWN);
+  }
+
+  U64 bishopsQueens = _pieces[WHITE][BISHOP] | _pieces[BLACK][BISHOP] | _pieces[WHITE][QUEEN] | _pieces[BLACK][QUEEN];
+  U64 rooksQueens = _pieces[WHITE][ROOK] | _pieces[BLACK][ROOK] | _pieces[WHITE][QUEEN] | _pieces[BLACK][QUEEN];
+
+  U64 attackers = _getAttackersTo(to, occupied);
+  Color side = _activePlayer;
+
+  while (captures < SEE_MAX_CAPTURES - 1) {
+    // Remove the last capturing piece, revealing any sliders behind it
+    occupied ^= fromSquare;
+    attackers |= (Attacks::getSlidingAttacks(BISHOP, to, occupied) & bishopsQueens) |
+        (Attacks::getSlidingAttacks(ROOK, to, occupied) & rooksQueens);
+    attackers &= occupied;
+
+    // Find the least valuable attacker of the side to capture next
+    side = getOppositeColor(side);
+    U64 sideAttackers = attackers & _allPieces[side];
+    if (!sideAttackers) {
+      break;
+    }
+
+    for (auto pieceType : SEE_ATTACKER_ORDER) {
+      U64 pieces = sideAttackers & _pieces[side][pieceType];
+      if (pieces) {
+        fromSquare = pieces & -pieces;
+
+        // Material balance if the exchange stops after this capture
+        captures++;
+        gains[captures] = seeValue(onSquare) - gains[captures - 1];
+
+        onSquare = pieceType;
+        break;
+      }
+    }
+  }
+
+  // Each side chooses between capturing and stopping the exchange
+  while (captures > 0) {
+    gains[captures - 1] = -std::max(-gains[captures - 1], gains[captures]);
+    captures--;
+  }
+
+  return gains[0];
+}
+
+U64 Board::_getAttackersTo(int square, U64 occupied) const {
+  U64 bishopsQueens = _pieces[WHITE][BISHOP] | _pieces[BLACK][BISHOP] | _pieces[WHITE][QUEEN] | _pieces[BLACK][QUEEN];
+  U64 rooksQueens = _pieces[WHITE][ROOK] | _pieces[BLACK][ROOK] | _pieces[WHITE][QUEEN] | _pieces[BLACK][QUEEN];
+
+  return (Attacks::getNonSlidingAttacks(PAWN, square, BLACK) & _pieces[WHITE][PAWN]) |
+      (Attacks::getNonSlidingAttacks(PAWN, square, WHITE) & _pieces[BLACK][PAWN]) |
+      (Attacks::getNonSlidingAttacks(KNIGHT, square) & (_pieces[WHITE][KNIGHT] | _pieces[BLACK][KNIGHT])) |
+      (Attacks::getNonSlidingAttacks(KING, square) & (_pieces[WHITE][KING] | _pieces[BLACK][KING])) |
+      (Attacks::getSlidingAttacks(BISHOP, square, occupied) & bishopsQueens) |
+      (Attacks::getSlidingAttacks(ROOK, square, occupied) & rooksQueens);
 }
 
 bool Board::_squareUnderAttack(Color color, int squareIndex) const {
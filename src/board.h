@@ -3,12 +3,45 @@
 
 #include "defs.h"
 #include "psquaretable.h"
+#include "score.h"
+#include "nnue.h"
 #include "zkey.h"
 #include "move.h"
 #include <string>
 
 class Move;
 
+/**
+ * @brief Irreversible board state saved by Board::doMove() and needed by
+ * Board::undoMove() to take back a move.
+ */
+struct UndoInfo {
+  /**
+   * @brief En passant target square before the move
+   */
+  U64 enPassant;
+
+  /**
+   * @brief Zobrist key before the move
+   */
+  ZKey zKey;
+
+  /**
+   * @brief Pawn structure Zobrist key before the move
+   */
+  ZKey pawnStructureZKey;
+
+  /**
+   * @brief Halfmove clock before the move
+   */
+  int halfmoveClock;
+
+  /**
+   * @brief Castling rights before the move (see Board::_castlingRights)
+   */
+  unsigned char castlingRights;
+};
+
 /**
  * @brief Represents a chess board.
  *
@@ -60,9 +93,39 @@ class Board {
   /**
    * @brief Performs the specified move on this board.
    *
+   * The returned UndoInfo can be passed to undoMove() along with the same move
+   * to restore this board to its state before the move.
+   *
    * @param move Move to perform on the board.
+   * @return State needed to undo the move
    */
-  void doMove(Move);
+  UndoInfo doMove(Move);
+
+  /**
+   * @brief Takes back the specified move, which must be the last move performed
+   * on this board.
+   *
+   * @param move Move to take back
+   * @param undoInfo State returned by doMove() when the move was performed
+   */
+  void undoMove(Move, const UndoInfo &);
+
+  /**
+   * @brief Passes the turn to the opponent without moving a piece (a null move).
+   *
+   * The en passant target square (if any) is cleared. Null moves are not
+   * legal chess moves, they are only used by the search for null move pruning.
+   *
+   * @return State needed to undo the null move
+   */
+  UndoInfo doNullMove();
+
+  /**
+   * @brief Takes back a null move, which must be the last move performed on this board.
+   *
+   * @param undoInfo State returned by doNullMove() when the null move was performed
+   */
+  void undoNullMove(const UndoInfo &);
 
   /**
    * @brief Returns true if white can castle kingside, false otherwise.
@@ -209,6 +272,60 @@ class Board {
    */
   ZKey getPawnStructureZKey() const;
 
+  /**
+   * @brief Returns a Zobrist Key for this board that only takes into account
+   * the number of pieces of each type and color
+   *
+   * Boards with the same material (regardless of where the pieces are) have
+   * the same material key.
+   *
+   * @return A Zobrist Key for this board that only takes into account material
+   */
+  ZKey getMaterialZKey() const;
+
+  /**
+   * @brief Returns the number of pieces of the given type and color on this board.
+   *
+   * @param color Color of pieces to count
+   * @param pieceType Type of pieces to count
+   * @return The number of pieces of the given type and color on this board
+   */
+  int getPieceCount(Color, PieceType) const;
+
+  /**
+   * @brief Returns the total material value of the given color's pieces.
+   *
+   * @param color Color to get the material value of
+   * @return The packed opening and endgame material value (see Eval::MATERIAL_VALUES)
+   */
+  Score getMaterial(Color) const;
+
+  /**
+   * @brief Returns the sum of Eval::detail::PHASE_WEIGHTS of all pieces on this board.
+   *
+   * @return The sum of the phase weights of all pieces on this board
+   */
+  int getPhaseWeight() const;
+
+  /**
+   * @brief Attaches the given AccumulatorStack to this board and refreshes it
+   * for the current position.
+   *
+   * While attached, the stack is updated as moves are made and undone on this
+   * board (see Nnue::AccumulatorStack). Copies of this board don't inherit the
+   * attached stack.
+   *
+   * @param accumulators AccumulatorStack to attach (nullptr to detach)
+   */
+  void setAccumulators(Nnue::AccumulatorStack *);
+
+  /**
+   * @brief Returns the AccumulatorStack attached to this board, or nullptr if there is none.
+   *
+   * @return The AccumulatorStack attached to this board
+   */
+  const Nnue::AccumulatorStack *getAccumulators() const;
+
   /**
    * @brief Returns the Piece Square Table of this board for its current state.
    *
@@ -241,6 +358,21 @@ class Board {
    */
   U64 getAttacksForSquare(PieceType, Color, int) const;
 
+  /**
+   * @brief Returns the static exchange evaluation (SEE) of the given move.
+   *
+   * The SEE is the material (in centipawns) that the side to move gains from
+   * the sequence of captures on the destination square of the move, where
+   * each side recaptures with its least valuable attacker and may stop
+   * capturing whenever continuing would lose material. Sliding pieces
+   * behind other attackers (x-rays) join the exchange once the pieces in
+   * front of them have captured. Pins and checks are ignored.
+   *
+   * @param move Move to evaluate (normally a capture)
+   * @return The material gained by the side to move (negative if material is lost)
+   */
+  int see(Move) const;
+
  private:
   /**
    * @name Attack bitboard generation functions.
@@ -295,6 +427,31 @@ class Board {
    */
   ZKey _pawnStructureZkey;
 
+  /**
+   * @brief Zobrist key taking into account only the number of each piece
+   */
+  ZKey _materialZKey;
+
+  /**
+   * @brief Array indexed by [color][piecetype] of the number of pieces of each type
+   */
+  int _pieceCounts[2][6];
+
+  /**
+   * @brief Array indexed by [color] of packed material values
+   */
+  Score _material[2];
+
+  /**
+   * @brief Sum of Eval::detail::PHASE_WEIGHTS of all pieces on the board
+   */
+  int _phaseWeight;
+
+  /**
+   * @brief NNUE accumulators updated as moves are made (nullptr if not attached)
+   */
+  Nnue::AccumulatorStackPtr _accumulators;
+
  private:
 
   /**
@@ -331,6 +488,16 @@ class Board {
    */
   bool _squareUnderAttack(Color, int) const;
 
+  /**
+   * @brief Returns a bitboard of the pieces of both colors attacking the given
+   * square, using the given occupancy for sliding pieces.
+   *
+   * @param square   Square being attacked (little endian rank file mapping)
+   * @param occupied Occupancy to use for sliding piece attacks
+   * @return A bitboard of all pieces attacking the square
+   */
+  U64 _getAttackersTo(int, U64) const;
+
   /**
    * @brief Update the castling rights for the given move.
    *
@@ -346,6 +513,12 @@ class Board {
    */
   void _updateNonPieceBitBoards();
 
+  /**
+   * @brief Sets the piece counts, material values, phase weight and material
+   * key based on the _pieces bitboards.
+   */
+  void _updateMaterial();
+
   /**
    * @brief Moves a piece between the given squares.
    *
@@ -67,6 +67,12 @@ const U64 ONE = U64(1);
 /** @brief Positive infinity to be used during search (eg. as a return value for winning) */
 const int INF = std::numeric_limits<int>::max();
 
+/** @brief Maximum number of plys from the root to any node of a search (not counting quiescence search) */
+const int MAX_PLY = 64;
+
+/** @brief Maximum number of plys quiescence search may search below a node of the main search */
+const int MAX_QSEARCH_PLY = 32;
+
 /**
  * @enum Color
  * @brief Represents a color.
@@ -15,42 +15,89 @@ U64 Eval::detail::NEIGHBOR_FILES[8]{
     FILE_F | FILE_H,
     FILE_G
 };
-U64 Eval::detail::PASSED_PAWN_MASKS[2][64];
-U64 Eval::detail::PAWN_SHIELD_MASKS[2][64];
-int Eval::detail::PHASE_WEIGHT_SUM = 0;
 
-void Eval::init() {
-  // Initialize king pawn shield masks
+namespace {
+constexpr Table<Table<U64, 64>, 2> makePawnShieldMasks() {
+  Table<Table<U64, 64>, 2> masks{};
+
   for (int i = 0; i < 64; i++) {
     U64 square = ONE << i;
 
-    detail::PAWN_SHIELD_MASKS[WHITE][i] = ((square << 8) | ((square << 7) & ~FILE_H) |
+    masks[WHITE][i] = ((square << 8) | ((square << 7) & ~FILE_H) |
         ((square << 9) & ~FILE_A)) & RANK_2;
-    detail::PAWN_SHIELD_MASKS[BLACK][i] = ((square >> 8) | ((square >> 7) & ~FILE_A) |
+    masks[BLACK][i] = ((square >> 8) | ((square >> 7) & ~FILE_A) |
         ((square >> 9) & ~FILE_H)) & RANK_7;
   }
 
-  // Initialize passed pawn masks
+  return masks;
+}
+
+constexpr Table<Table<U64, 64>, 2> makePassedPawnMasks() {
+  Rays::detail::RayTable rays = Rays::detail::_makeRays();
+  Table<Table<U64, 64>, 2> masks{};
+
   for (int square = 0; square < 64; square++) {
-    U64 currNorthRay = Rays::getRay(Rays::NORTH, square);
-    U64 currSouthRay = Rays::getRay(Rays::SOUTH, square);
+    U64 currNorthRay = rays[Rays::NORTH][square];
+    U64 currSouthRay = rays[Rays::SOUTH][square];
 
-    detail::PASSED_PAWN_MASKS[WHITE][square] =
-        currNorthRay | _eastN(currNorthRay, 1) | _westN(currNorthRay, 1);
-    detail::PASSED_PAWN_MASKS[BLACK][square] =
-        currSouthRay | _westN(currSouthRay, 1) | _eastN(currSouthRay, 1);
+    masks[WHITE][square] = currNorthRay | _eastN(currNorthRay, 1) | _westN(currNorthRay, 1);
+    masks[BLACK][square] = currSouthRay | _westN(currSouthRay, 1) | _eastN(currSouthRay, 1);
   }
 
-  // Initialize PHASE_WEIGHT_SUM
-  detail::PHASE_WEIGHT_SUM += detail::PHASE_WEIGHTS[PAWN] * 16;
-  detail::PHASE_WEIGHT_SUM += detail::PHASE_WEIGHTS[KNIGHT] * 4;
-  detail::PHASE_WEIGHT_SUM += detail::PHASE_WEIGHTS[BISHOP] * 4;
-  detail::PHASE_WEIGHT_SUM += detail::PHASE_WEIGHTS[ROOK] * 4;
-  detail::PHASE_WEIGHT_SUM += detail::PHASE_WEIGHTS[QUEEN] * 2;
+  return masks;
+}
+}
+
+constexpr Table<Table<U64, 64>, 2> Eval::detail::PASSED_PAWN_MASKS = makePassedPawnMasks();
+constexpr Table<Table<U64, 64>, 2> Eval::detail::PAWN_SHIELD_MASKS = makePawnShieldMasks();
+
+U64 Eval::detail::passedPawnBitboard(const Board &board, Color color) {
+  U64 passed = ZERO;
+  U64 pawns = board.getPieces(color, PAWN);
+  U64 enemyPawns = board.getPieces(getOppositeColor(color), PAWN);
+
+  while (pawns) {
+    int square = _popLsb(pawns);
+    if ((enemyPawns & PASSED_PAWN_MASKS[color][square]) == ZERO) {
+      passed |= ONE << square;
+    }
+  }
+
+  return passed;
+}
+
+U64 Eval::detail::attackSpan(U64 pawns, Color color) {
+  U64 span;
+  if (color == WHITE) {
+    span = ((pawns << 7) & ~FILE_H) | ((pawns << 9) & ~FILE_A);
+    span |= span << 8;
+    span |= span << 16;
+    span |= span << 32;
+  } else {
+    span = ((pawns >> 7) & ~FILE_A) | ((pawns >> 9) & ~FILE_H);
+    span |= span >> 8;
+    span |= span >> 16;
+    span |= span >> 32;
+  }
+
+  return span;
+}
+
+unsigned char Eval::detail::fileMask(U64 pawns) {
+  // Fold every rank onto the first rank
+  pawns |= pawns >> 32;
+  pawns |= pawns >> 16;
+  pawns |= pawns >> 8;
+
+  return static_cast<unsigned char>(pawns & RANK_1);
+}
+
+unsigned char Eval::detail::isolatedFiles(unsigned char files) {
+  return files & ~((files << 1) | (files >> 1));
 }
 
 int Eval::getMaterialValue(PieceType pieceType) {
-  return MATERIAL_VALUES[OPENING][pieceType];
+  return getOpeningScore(MATERIAL_VALUES[pieceType]);
 }
 
 bool Eval::hasBishopPair(const Board &board, Color color) {
@@ -58,8 +105,8 @@ bool Eval::hasBishopPair(const Board &board, Color color) {
       && ((board.getPieces(color, BISHOP) & WHITE_SQUARES) != ZERO);
 }
 
-int Eval::evaluateMobility(const Board &board, GamePhase phase, Color color) {
-  int score = 0;
+Score Eval::evaluateMobility(const Board &board, Color color) {
+  Score score = 0;
 
   // Special case for pawn moves
   U64 pawns = board.getPieces(color, PAWN);
@@ -74,7 +121,7 @@ int Eval::evaluateMobility(const Board &board, GamePhase phase, Color color) {
     pawnAttacks = ((pawns >> 7) & ~FILE_A) | ((pawns >> 9) & ~FILE_H);
   }
   pawnAttacks &= board.getAttackable(getOppositeColor(color));
-  score += _popCount(singlePawnPushes | doublePawnPushes | pawnAttacks) * MOBILITY_BONUS[phase][PAWN];
+  score += _popCount(singlePawnPushes | doublePawnPushes | pawnAttacks) * MOBILITY_BONUS[PAWN];
 
   // All other pieces
   for (auto pieceType : {ROOK, KNIGHT, BISHOP, QUEEN, KING}) {
@@ -83,7 +130,7 @@ int Eval::evaluateMobility(const Board &board, GamePhase phase, Color color) {
     while (pieces) {
       int square = _popLsb(pieces);
       U64 attackBitBoard = board.getAttacksForSquare(pieceType, color, square);
-      score += _popCount(attackBitBoard) * MOBILITY_BONUS[phase][pieceType];
+      score += _popCount(attackBitBoard) * MOBILITY_BONUS[pieceType];
     }
   }
 
@@ -103,43 +150,18 @@ int Eval::rooksOnOpenFiles(const Board &board, Color color) {
 }
 
 int Eval::passedPawns(const Board &board, Color color) {
-  int passed = 0;
-  U64 pawns = board.getPieces(color, PAWN);
-
-  while (pawns != ZERO) {
-    int square = _popLsb(pawns);
-    if ((board.getPieces(getOppositeColor(color), PAWN) & detail::PASSED_PAWN_MASKS[color][square]) == ZERO) passed++;
-    pawns &= ~detail::FILES[square % 8];
-  }
-
-  return passed;
+  U64 passed = detail::passedPawnBitboard(board, color);
+  return _popCount(static_cast<U64>(detail::fileMask(passed)));
 }
 
 int Eval::doubledPawns(const Board &board, Color color) {
-  int doubled = 0;
-
-  for (U64 file : detail::FILES) {
-    int pawnsOnFile = _popCount(file & board.getPieces(color, PAWN));
-
-    if (pawnsOnFile > 1) doubled += (pawnsOnFile - 1);
-  }
-
-  return doubled;
+  U64 pawns = board.getPieces(color, PAWN);
+  return _popCount(pawns) - _popCount(static_cast<U64>(detail::fileMask(pawns)));
 }
 
 int Eval::isolatedPawns(const Board &board, Color color) {
-  int isolated = 0;
-
-  U64 pawns = board.getPieces(color, PAWN);
-
-  for (int fileNumber = 0; fileNumber < 8; fileNumber++) {
-    U64 fileMask = detail::FILES[fileNumber];
-    U64 neighborFileMask = detail::NEIGHBOR_FILES[fileNumber];
-
-    if ((fileMask & pawns) && !(neighborFileMask & pawns)) isolated++;
-  }
-
-  return isolated;
+  unsigned char files = detail::fileMask(board.getPieces(color, PAWN));
+  return _popCount(static_cast<U64>(detail::isolatedFiles(files)));
 }
 
 int Eval::pawnsShieldingKing(const Board &board, Color color) {
@@ -147,107 +169,77 @@ int Eval::pawnsShieldingKing(const Board &board, Color color) {
   return _popCount(detail::PAWN_SHIELD_MASKS[color][kingSquare] & board.getPieces(color, PAWN));
 }
 
-int Eval::evaluatePawnStructure(const Board &board, Color color, GamePhase phase) {
-  if (PawnStructureTable::exists(board.getPawnStructureZKey())) {
-    int whiteScore = PawnStructureTable::get(board.getPawnStructureZKey())->scores[phase];
+void Eval::evaluatePawnStructure(const Board &board, PawnStructureTable::Entry &entry) {
+  for (auto color : {WHITE, BLACK}) {
+    U64 pawns = board.getPieces(color, PAWN);
 
-    if (color == BLACK) {
-      return -whiteScore;
-    } else {
-      return whiteScore;
-    }
+    entry.passedPawns[color] = detail::passedPawnBitboard(board, color);
+    entry.attackSpans[color] = detail::attackSpan(pawns, color);
+    entry.files[color] = detail::fileMask(pawns);
   }
 
-  int scores[2] = {0};
-
-  // Passed pawns
-  int passedPawnDiff = passedPawns(board, WHITE) - passedPawns(board, BLACK);
-  scores[OPENING] += PASSED_PAWN_BONUS[OPENING] * passedPawnDiff;
-  scores[ENDGAME] += PASSED_PAWN_BONUS[ENDGAME] * passedPawnDiff;
+  // Passed pawns (each file containing a passed pawn is counted once)
+  int passedPawnDiff = _popCount(static_cast<U64>(detail::fileMask(entry.passedPawns[WHITE])))
+      - _popCount(static_cast<U64>(detail::fileMask(entry.passedPawns[BLACK])));
 
   // Doubled pawns
-  int doubledPawnDiff = doubledPawns(board, WHITE) - doubledPawns(board, BLACK);
-  scores[OPENING] += DOUBLED_PAWN_PENALTY[OPENING] * doubledPawnDiff;
-  scores[ENDGAME] += DOUBLED_PAWN_PENALTY[ENDGAME] * doubledPawnDiff;
+  int doubledPawnDiff =
+      (_popCount(board.getPieces(WHITE, PAWN)) - _popCount(static_cast<U64>(entry.files[WHITE])))
+          - (_popCount(board.getPieces(BLACK, PAWN)) - _popCount(static_cast<U64>(entry.files[BLACK])));
 
   // Isolated pawns
-  int isolatedPawnDiff = isolatedPawns(board, WHITE) - isolatedPawns(board, BLACK);
-  scores[OPENING] += ISOLATED_PAWN_PENALTY[OPENING] * isolatedPawnDiff;
-  scores[ENDGAME] += ISOLATED_PAWN_PENALTY[ENDGAME] * isolatedPawnDiff;
+  int isolatedPawnDiff = _popCount(static_cast<U64>(detail::isolatedFiles(entry.files[WHITE])))
+      - _popCount(static_cast<U64>(detail::isolatedFiles(entry.files[BLACK])));
+
+  entry.score = PASSED_PAWN_BONUS * passedPawnDiff
+      + DOUBLED_PAWN_PENALTY * doubledPawnDiff
+      + ISOLATED_PAWN_PENALTY * isolatedPawnDiff;
+}
 
-  PawnStructureTable::PawnStructureEntry entry{};
-  entry.scores[OPENING] = scores[OPENING];
-  entry.scores[ENDGAME] = scores[ENDGAME];
+int Eval::getPhase(const Board &board) {
+  int phase = detail::PHASE_WEIGHT_SUM - board.getPhaseWeight();
 
-  PawnStructureTable::set(board.getPawnStructureZKey(), entry);
+  // Transform phase from the range 0 - PHASE_WEIGHT_SUM to 0 - PHASE_WEIGHT_MAX
+  return ((phase * MAX_PHASE) + (detail::PHASE_WEIGHT_SUM / 2)) / detail::PHASE_WEIGHT_SUM;
+}
 
-  if (color == BLACK) {
-    return -scores[phase];
+int Eval::evaluate(const Board &board, Color color, PawnStructureTable *pawnTable) {
+  PawnStructureTable::Entry scratchEntry;
+  const PawnStructureTable::Entry *pawnEntry = &scratchEntry;
+  if (pawnTable) {
+    pawnEntry = &pawnTable->probe(board);
   } else {
-    return scores[phase];
+    evaluatePawnStructure(board, scratchEntry);
   }
-}
 
-template<GamePhase phase>
-int Eval::evaluateForPhase(const Board &board, Color color) {
-  int score = 0;
+  Score score = 0;
 
   Color otherColor = getOppositeColor(color);
 
   // Material value
-  score += MATERIAL_VALUES[phase][PAWN]
-      * (_popCount(board.getPieces(color, PAWN)) - _popCount(board.getPieces(otherColor, PAWN)));
-  score += MATERIAL_VALUES[phase][KNIGHT]
-      * (_popCount(board.getPieces(color, KNIGHT)) - _popCount(board.getPieces(otherColor, KNIGHT)));
-  score += MATERIAL_VALUES[phase][BISHOP]
-      * (_popCount(board.getPieces(color, BISHOP)) - _popCount(board.getPieces(otherColor, BISHOP)));
-  score += MATERIAL_VALUES[phase][ROOK]
-      * (_popCount(board.getPieces(color, ROOK)) - _popCount(board.getPieces(otherColor, ROOK)));
-  score += MATERIAL_VALUES[phase][QUEEN]
-      * (_popCount(board.getPieces(color, QUEEN)) - _popCount(board.getPieces(otherColor, QUEEN)));
+  score += board.getMaterial(color) - board.getMaterial(otherColor);
 
   // Piece square tables
-  score += board.getPSquareTable().getScore(phase, color) - board.getPSquareTable().getScore(phase, otherColor);
+  score += board.getPSquareTable().getScore(color) - board.getPSquareTable().getScore(otherColor);
 
   // Mobility
-  score += evaluateMobility(board, phase, color) - evaluateMobility(board, phase, otherColor);
+  score += evaluateMobility(board, color) - evaluateMobility(board, otherColor);
 
   // Rook on open file
-  score += ROOK_OPEN_FILE_BONUS[phase] * (rooksOnOpenFiles(board, color) - rooksOnOpenFiles(board, otherColor));
+  score += ROOK_OPEN_FILE_BONUS * (rooksOnOpenFiles(board, color) - rooksOnOpenFiles(board, otherColor));
 
   // Bishop pair
-  score += hasBishopPair(board, color) ? BISHOP_PAIR_BONUS[phase] : 0;
-  score -= hasBishopPair(board, otherColor) ? BISHOP_PAIR_BONUS[phase] : 0;
+  score += hasBishopPair(board, color) ? BISHOP_PAIR_BONUS : 0;
+  score -= hasBishopPair(board, otherColor) ? BISHOP_PAIR_BONUS : 0;
 
   // Pawn structure
-  score += evaluatePawnStructure(board, color, phase);
-
-  // King pawn shield (not done in endgame so omit)
-  if (phase == OPENING) {
-    score +=
-        KING_PAWN_SHIELD_BONUS[OPENING] * (pawnsShieldingKing(board, color) - pawnsShieldingKing(board, otherColor));
-  }
-
-  return score;
-}
-
-int Eval::getPhase(const Board &board) {
-  int phase = detail::PHASE_WEIGHT_SUM;
-
-  for (auto pieceType : {ROOK, KNIGHT, BISHOP, QUEEN}) {
-    phase -= _popCount(board.getPieces(WHITE, pieceType)) * detail::PHASE_WEIGHTS[pieceType];
-    phase -= _popCount(board.getPieces(BLACK, pieceType)) * detail::PHASE_WEIGHTS[pieceType];
-  }
+  score += (color == WHITE) ? pawnEntry->score : -pawnEntry->score;
 
-  // Transform phase from the range 0 - PHASE_WEIGHT_SUM to 0 - PHASE_WEIGHT_MAX
-  return ((phase * MAX_PHASE) + (detail::PHASE_WEIGHT_SUM / 2)) / detail::PHASE_WEIGHT_SUM;
-}
+  // King pawn shield
+  score += KING_PAWN_SHIELD_BONUS * (pawnsShieldingKing(board, color) - pawnsShieldingKing(board, otherColor));
 
-int Eval::evaluate(const Board &board, Color color) {
-  int openingScore = evaluateForPhase<OPENING>(board, color);
-  int endgameScore = evaluateForPhase<ENDGAME>(board, color);
   int phase = getPhase(board);
 
   // Interpolate between opening/endgame scores depending on the phase
-  return ((openingScore * (MAX_PHASE - phase)) + (endgameScore * phase)) / MAX_PHASE;
+  return ((getOpeningScore(score) * (MAX_PHASE - phase)) + (getEndgameScore(score) * phase)) / MAX_PHASE;
 }
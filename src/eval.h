@@ -4,6 +4,9 @@
 #include "defs.h"
 #include "movegen.h"
 #include "bitutils.h"
+#include "table.h"
+#include "score.h"
+#include "pawnstructuretable.h"
 
 /**
  * @brief Namespace containing board evaluation functions
@@ -25,14 +28,51 @@ extern U64 NEIGHBOR_FILES[8];
  * must be free of enemy pawns for a pawn of the given color on the given
  * square to be considered passed
  */
-extern U64 PASSED_PAWN_MASKS[2][64];
+extern const Table<Table<U64, 64>, 2> PASSED_PAWN_MASKS;
 
 /**
  * @brief Array of masks indexed by [Color][square] containing all squares
  * considered part of the "pawn shield" for a king of the given color on the
  * given square
  */
-extern U64 PAWN_SHIELD_MASKS[2][64];
+extern const Table<Table<U64, 64>, 2> PAWN_SHIELD_MASKS;
+
+/**
+ * @brief Returns a bitboard of all passed pawns of the given color on the given board
+ *
+ * @param board Board to find passed pawns on
+ * @param color Color of passed pawns to find
+ * @return A bitboard of all passed pawns of the given color
+ */
+U64 passedPawnBitboard(const Board &, Color);
+
+/**
+ * @brief Returns a bitboard of all squares that the given pawns can attack
+ * as they advance up the board
+ *
+ * @param pawns Bitboard of pawns to get the attack span of
+ * @param color Color of the given pawns
+ * @return The attack span of the given pawns
+ */
+U64 attackSpan(U64, Color);
+
+/**
+ * @brief Returns a mask of the files occupied by the given bitboard (bit n is
+ * set if any square on file n is set)
+ *
+ * @param bitboard Bitboard to get the occupied files of
+ * @return A mask of the files occupied by the given bitboard
+ */
+unsigned char fileMask(U64);
+
+/**
+ * @brief Returns the files in the given file mask that have no neighboring
+ * files in the mask
+ *
+ * @param files File mask as returned by fileMask()
+ * @return A mask of isolated files
+ */
+unsigned char isolatedFiles(unsigned char);
 
 /**
  * @brief Weights for each piece used to calculate the game phase based off
@@ -55,96 +95,81 @@ const int PHASE_WEIGHTS[6] = {
  * by how many of those pieces are initially on the board (Multiply the
  * value for pawns by 16, knights by 4, etc.).
  */
-extern int PHASE_WEIGHT_SUM;
+const int PHASE_WEIGHT_SUM = PHASE_WEIGHTS[PAWN] * 16 +
+    PHASE_WEIGHTS[KNIGHT] * 4 +
+    PHASE_WEIGHTS[BISHOP] * 4 +
+    PHASE_WEIGHTS[ROOK] * 4 +
+    PHASE_WEIGHTS[QUEEN] * 2;
 };
 
 /**
  * @brief Bonuses given to a player having a move available (opening/endgame)
  */
-const int MOBILITY_BONUS[2][6] = {
-    [OPENING] = {
-        [PAWN] = 0,
-        [ROOK] = 0,
-        [KNIGHT] = 4,
-        [BISHOP] = 3,
-        [QUEEN] = 0,
-        [KING] = 0
-    },
-    [ENDGAME] = {
-        [PAWN] = 1,
-        [ROOK] = 1,
-        [KNIGHT] = 6,
-        [BISHOP] = 2,
-        [QUEEN] = 1,
-        [KING] = 1
-    }
+const Score MOBILITY_BONUS[6] = {
+    [PAWN] = makeScore(0, 1),
+    [ROOK] = makeScore(0, 1),
+    [KNIGHT] = makeScore(4, 6),
+    [BISHOP] = makeScore(3, 2),
+    [QUEEN] = makeScore(0, 1),
+    [KING] = makeScore(0, 1)
 };
 
 /**
- * @brief Array indexed by [Phase][PieceType] of material values (in centipawns)
+ * @brief Array indexed by [PieceType] of material values (opening/endgame, in centipawns)
  */
-const int MATERIAL_VALUES[2][6] = {
-    [OPENING] = {
-        [PAWN] = 100,
-        [ROOK] = 500,
-        [KNIGHT] = 320,
-        [BISHOP] = 330,
-        [QUEEN] = 900,
-        [KING] = 0
-    },
-    [ENDGAME] = {
-        [PAWN] = 140,
-        [ROOK] = 500,
-        [KNIGHT] = 300,
-        [BISHOP] = 300,
-        [QUEEN] = 900,
-        [KING] = 0
-    }
+const Score MATERIAL_VALUES[6] = {
+    [PAWN] = makeScore(100, 140),
+    [ROOK] = makeScore(500, 500),
+    [KNIGHT] = makeScore(320, 300),
+    [BISHOP] = makeScore(330, 300),
+    [QUEEN] = makeScore(900, 900),
+    [KING] = makeScore(0, 0)
 };
 
 /**
- * @brief Bonuses given to a player for each rook on an open file (opening/endgame)
+ * @brief Bonus given to a player for each rook on an open file (opening/endgame)
  */
-const int ROOK_OPEN_FILE_BONUS[2] = {[OPENING] = 20, [ENDGAME] = 40};
+const Score ROOK_OPEN_FILE_BONUS = makeScore(20, 40);
 
 /**
- * @brief Bonuses given to a player for having a passed pawn (opening/endgame)
+ * @brief Bonus given to a player for having a passed pawn (opening/endgame)
  */
-const int PASSED_PAWN_BONUS[2] = {[OPENING] = 10, [ENDGAME] = 70};
+const Score PASSED_PAWN_BONUS = makeScore(10, 70);
 
 /**
- * @brief Penalties given to a player for having a doubled pawn (opening/endgame)
+ * @brief Penalty given to a player for having a doubled pawn (opening/endgame)
  */
-const int DOUBLED_PAWN_PENALTY[2] = {[OPENING] = -20, [ENDGAME] = -30};
+const Score DOUBLED_PAWN_PENALTY = makeScore(-20, -30);
 
 /**
- * @brief Penalties given to a player for having an isolated pawn (opening/endgame)
+ * @brief Penalty given to a player for having an isolated pawn (opening/endgame)
  */
-const int ISOLATED_PAWN_PENALTY[2] = {[OPENING] = -15, [ENDGAME] = -30};
+const Score ISOLATED_PAWN_PENALTY = makeScore(-15, -30);
 
 /**
- * @brief Bonuses given to a player for having bishops on black and white squares (opening/endgame)
+ * @brief Bonus given to a player for having bishops on black and white squares (opening/endgame)
  */
-const int BISHOP_PAIR_BONUS[2] = {[OPENING] = 45, [ENDGAME] = 55};
+const Score BISHOP_PAIR_BONUS = makeScore(45, 55);
 
 /**
- * @brief Bonuses given to a player for each pawn shielding their king (opening/endgame)
+ * @brief Bonus given to a player for each pawn shielding their king (opening/endgame)
  */
-const int KING_PAWN_SHIELD_BONUS[2] = {[OPENING] = 10, [ENDGAME] = 0};
-
-/**
- * @brief Initializes all inner constants used by functions in the Eval namespace
- */
-void init();
+const Score KING_PAWN_SHIELD_BONUS = makeScore(10, 0);
 
 /**
  * @brief Returns the evaluated advantage of the given color in centipawns
  *
+ * Every evaluation term is computed once as a packed opening/endgame Score,
+ * and the opening and endgame totals are interpolated according to the
+ * game phase (see getPhase()).
+ *
  * @param board Board to evaluate
  * @param color Color to evaluate advantage of
+ * @param pawnTable Pawn structure table to cache pawn structure scores in
+ * (if nullptr, pawn structure is evaluated from scratch)
  * @return Advantage of the given color in centipawns
  */
-int evaluate(const Board &, Color);
+int evaluate(const Board &, Color, PawnStructureTable * = nullptr);
 
 /**
  * @brief Returns a numeric representation of the given board's phase based
@@ -162,19 +187,6 @@ int getPhase(const Board &);
  */
 const int MAX_PHASE = 256;
 
-/**
- * @brief Returns the evaluated advantage of the given color in centipawns
- * assuming the game is in the given phase
- *
- * @tparam phase Phase of game to evaluate for
- * @param board Board to evaluate
- * @param color Color to evaluate advantage of
- * @return Advantage of the given color in centipawns, assuming the given
- * game phase
- */
-template<GamePhase phase>
-int evaluateForPhase(const Board &, Color);
-
 /**
  * @brief Returns the value of the given PieceType used for evaluation
  * purposes in centipawns
@@ -189,20 +201,19 @@ int evaluateForPhase(const Board &, Color);
 int getMaterialValue(PieceType);
 
 /**
- * @brief Evaluates pawn structure and returns a score in centipawns
+ * @brief Evaluates the pawn structure of the given board and fills in the
+ * given pawn structure table entry (except for its key)
  *
- * This function internally uses Eval::isolatedPawns(), Eval::passedPawns()
- * and Eval::doubledPawns(), weights each value according to its score
- * and returns the pawn structure score in centipawns.
+ * Passed, doubled and isolated pawns are weighted according to their
+ * scores and stored as white's pawn structure score.
  *
- * Additionally, if the board's pawn structure has been seen before, this
- * function will look up its value from the pawn structure hash table or
- * store its score in the table if it hasn't yet been seen.
+ * This is called by PawnStructureTable::probe() when a pawn structure isn't
+ * in the table.
  *
- * @return The score for the given color (in centipawns), considering only
- * its pawn structure
+ * @param board Board to evaluate the pawn structure of
+ * @param entry Entry to store the pawn structure scores and bitboards in
  */
-int evaluatePawnStructure(const Board &, Color, GamePhase);
+void evaluatePawnStructure(const Board &, PawnStructureTable::Entry &);
 
 /**
  * @brief Returns true if the given color has at least one bishop on black squares
@@ -216,18 +227,16 @@ int evaluatePawnStructure(const Board &, Color, GamePhase);
 bool hasBishopPair(const Board &, Color);
 
 /**
- * @brief Returns the weighted mobility score (in centipawns) for the given
- * phase and color
+ * @brief Returns the weighted mobility score (in centipawns) for the given color
  *
  * This method calculates all pseudo-legal moves for the given colors, and sums
  * the number of moves, weighting the sum as per Eval::MOBILITY_BONUS.
  *
  * @param board Board to use when generating moves
- * @param phase GamePhase to evaluate board for
  * @param color Color to count pseudo-legal moves for
- * @return The number of pseudo-legal moves avaliable to the given color
+ * @return The packed opening and endgame mobility score of the given color
  */
-int evaluateMobility(const Board &board, GamePhase phase, Color color);
+Score evaluateMobility(const Board &, Color);
 
 /**
  * @brief Returns the number of rooks on open files that the given color has on
@@ -244,9 +253,11 @@ int rooksOnOpenFiles(const Board &, Color);
  * @brief Returns the number of passed pawns that the given color has on the
  * given board
  *
+ * Each file containing a passed pawn is only counted once.
+ *
  * @param board Board to check for passed pawns
  * @param color Color of player to check for passed pawns
- * @return
+ * @return The number of files containing a passed pawn of the given color
  */
 int passedPawns(const Board &, Color);
 
@@ -0,0 +1,60 @@
+#include "evalcache.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+EvalCache::EvalCache(int sizeMb) : _size(ONE), _probes(0), _hits(0) {
+  if (sizeMb < 1) {
+    sizeMb = 1;
+  } else if (sizeMb > MAX_SIZE_MB) {
+    sizeMb = MAX_SIZE_MB;
+  }
+
+  U64 maxEntries = (static_cast<U64>(sizeMb) * 1024 * 1024) / sizeof(U64);
+  while (_size * 2 <= maxEntries) {
+    _size *= 2;
+  }
+
+  // Value initialization zeroes all entries, marking them as empty
+  _table.reset(new U64[_size]());
+}
+
+void EvalCache::clear() {
+  std::memset(_table.get(), 0, _size * sizeof(U64));
+  resetStats();
+}
+
+void EvalCache::resetStats() {
+  _probes = 0;
+  _hits = 0;
+}
+
+bool EvalCache::probe(const ZKey &key, int &score) {
+  _probes++;
+
+  U64 entry = _table[key.getValue() & (_size - 1)];
+  if (entry == ZERO || ((entry ^ key.getValue()) & ~SCORE_MASK) != ZERO) {
+    return false;
+  }
+
+  score = static_cast<int16_t>(entry & SCORE_MASK);
+  _hits++;
+  return true;
+}
+
+void EvalCache::store(const ZKey &key, int score) {
+  if (score < std::numeric_limits<int16_t>::min() || score > std::numeric_limits<int16_t>::max()) {
+    return;
+  }
+
+  U64 entry = (key.getValue() & ~SCORE_MASK) | static_cast<uint16_t>(score);
+  _table[key.getValue() & (_size - 1)] = entry;
+}
+
+unsigned long long EvalCache::getProbes() const {
+  return _probes;
+}
+
+unsigned long long EvalCache::getHits() const {
+  return _hits;
+}
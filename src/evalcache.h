@@ -0,0 +1,111 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include "defs.h"
+#include "zkey.h"
+#include <memory>
+
+/**
+ * @brief A fixed size hash table of static evaluation scores.
+ *
+ * Positions reached again through transpositions don't need to be evaluated
+ * again, so evaluations are cached by Zobrist key. Each entry is a single 64
+ * bit word holding the upper 48 bits of the key and a 16 bit score. The lower
+ * bits of the key select the entry, so with the default size the whole key is
+ * verified.
+ *
+ * The table is direct mapped (new entries always replace old ones) and is not
+ * thread safe, so each search thread owns its own EvalCache. Every probe is
+ * counted so that the hit rate can be reported.
+ */
+class EvalCache {
+ public:
+  /**
+   * @brief Default size of an evaluation cache in megabytes.
+   */
+  static const int DEFAULT_SIZE_MB = 1;
+
+  /**
+   * @brief Maximum size of an evaluation cache in megabytes.
+   */
+  static const int MAX_SIZE_MB = 1024;
+
+  /**
+   * @brief Constructs a new empty evaluation cache of the given size.
+   *
+   * @param sizeMb Size of the cache in megabytes (clamped to
+   * [1, MAX_SIZE_MB] and rounded down to a power of two number of entries)
+   */
+  EvalCache(int= DEFAULT_SIZE_MB);
+
+  /**
+   * @brief Removes all evaluations from this cache and resets its probe and hit counts.
+   */
+  void clear();
+
+  /**
+   * @brief Resets the probe and hit counts of this cache, keeping its evaluations.
+   */
+  void resetStats();
+
+  /**
+   * @brief Looks up the evaluation of the position with the given ZKey.
+   *
+   * @param key ZKey of the position to look up
+   * @param score Set to the cached evaluation if one was found
+   * @return true if an evaluation was found, false otherwise
+   */
+  bool probe(const ZKey &, int &);
+
+  /**
+   * @brief Stores the evaluation of the position with the given ZKey.
+   *
+   * Scores that don't fit in 16 bits are not stored.
+   *
+   * @param key ZKey of the evaluated position
+   * @param score Evaluation of the position
+   */
+  void store(const ZKey &, int);
+
+  /**
+   * @brief Returns the number of times this cache has been probed.
+   *
+   * @return The number of times this cache has been probed
+   */
+  unsigned long long getProbes() const;
+
+  /**
+   * @brief Returns the number of probes of this cache that found an evaluation.
+   *
+   * @return The number of probes of this cache that found an evaluation
+   */
+  unsigned long long getHits() const;
+
+ private:
+  /**
+   * @brief Mask of the bits of each entry that hold the score.
+   */
+  static const U64 SCORE_MASK = 0xffffull;
+
+  /**
+   * @brief Entries in this cache (0 if empty).
+   */
+  std::unique_ptr<U64[]> _table;
+
+  /**
+   * @brief Number of entries in this cache (always a power of two).
+   */
+  U64 _size;
+
+  /**
+   * @brief Number of times this cache has been probed.
+   */
+  unsigned long long _probes;
+
+  /**
+   * @brief Number of probes of this cache that found an evaluation.
+   */
+  unsigned long long _hits;
+};
+
+#endif
@@ -8,39 +8,132 @@ GeneralMovePicker::GeneralMovePicker(const OrderingInfo *orderingInfo, const Boa
   _moves = moveList;
   _board = board;
   _currHead = 0;
-  _scoreMoves();
-}
+  _badCaptureCount = 0;
+  _badCaptureHead = 0;
+  _stage = HASH_MOVE;
+  _hasNextMove = false;
+  _pickedQuiet = false;
+
+  _moves->clear();
 
-void GeneralMovePicker::_scoreMoves() {
-  const TranspTableEntry *ttEntry = _orderingInfo->getTt()->getEntry(_board->getZKey());
-  Move pvMove;
-  if (ttEntry) {
-    pvMove = ttEntry->getBestMove();
+  // On the previous principal variation, its move is tried first (even if the
+  // transposition table entry has been overwritten)
+  _hashMove = _orderingInfo->getPvMove(_orderingInfo->getPly(), *_board);
+
+  TranspTableEntry ttEntry;
+  if ((_hashMove.getFlags() & Move::NULL_MOVE) && _orderingInfo->getTt()->probe(_board->getZKey(), ttEntry)) {
+    _hashMove = ttEntry.getBestMove();
   }
 
+  _killer1 = _orderingInfo->getKiller1(_orderingInfo->getPly());
+  _killer2 = _orderingInfo->getKiller2(_orderingInfo->getPly());
+}
+
+void GeneralMovePicker::_scoreCaptures() {
   for (auto &move : *_moves) {
-    if (move == pvMove) {
-      move.setValue(INF);
-    } else if (move.getFlags() & Move::CAPTURE) {
+    if (move.getFlags() & (Move::CAPTURE | Move::EN_PASSANT)) {
       move.setValue(CAPTURE_BONUS + _mvvLvaTable[move.getCapturedPieceType()][move.getPieceType()]);
-    } else if (move.getFlags() & Move::PROMOTION) {
+    } else { // Promotion
       move.setValue(PROMOTION_BONUS + Eval::getMaterialValue(move.getPromotionPieceType()));
-    } else if (move == _orderingInfo->getKiller1(_orderingInfo->getPly())) {
-      move.setValue(KILLER1_BONUS);
-    } else if (move == _orderingInfo->getKiller2(_orderingInfo->getPly())) {
-      move.setValue(KILLER2_BONUS);
-    } else { // Quiet
-      move.setValue(QUIET_BONUS + _orderingInfo->getHistory(_board->getActivePlayer(), move.getFrom(), move.getTo()));
     }
   }
 }
 
-bool GeneralMovePicker::hasNext() const {
-  return _currHead < _moves->size();
+void GeneralMovePicker::_scoreQuiets() {
+  for (size_t i = _currHead; i < _moves->size(); i++) {
+    Move &move = _moves->at(i);
+    move.setValue(QUIET_BONUS + _orderingInfo->getHistory(_board->getActivePlayer(), move.getFrom(), move.getTo()));
+  }
 }
 
-Move GeneralMovePicker::getNext() {
-  size_t bestIndex;
+bool GeneralMovePicker::_isValidKiller(Move killer) const {
+  if (killer.getFlags() & (Move::CAPTURE | Move::PROMOTION | Move::EN_PASSANT)) {
+    return false;
+  }
+
+  return !(killer == _hashMove) && MoveGen::isLegal(*_board, killer);
+}
+
+bool GeneralMovePicker::_findNext() {
+  while (true) {
+    switch (_stage) {
+      case HASH_MOVE:
+        _stage = GEN_CAPTURES;
+        if (MoveGen::isLegal(*_board, _hashMove)) {
+          _nextMove = _hashMove;
+          return true;
+        }
+        break;
+      case GEN_CAPTURES:
+        MoveGen::genLegalMoves(*_board, *_moves, MoveGen::CAPTURES);
+        _scoreCaptures();
+        _stage = CAPTURES;
+        break;
+      case CAPTURES:
+        while (_currHead < _moves->size()) {
+          Move move = _pickBest();
+          if (move == _hashMove) {
+            continue;
+          }
+
+          // Defer losing captures until after quiet moves (all moves before
+          // _currHead have been picked, so they can be overwritten)
+          if (MovePicker::isLosingCapture(*_board, move)) {
+            _moves->at(_badCaptureCount++) = move;
+            continue;
+          }
+
+          _nextMove = move;
+          return true;
+        }
+        _stage = KILLER1;
+        break;
+      case KILLER1:
+        _stage = KILLER2;
+        if (_isValidKiller(_killer1)) {
+          _nextMove = _killer1;
+          return true;
+        }
+        break;
+      case KILLER2:
+        _stage = GEN_QUIETS;
+        if (!(_killer2 == _killer1) && _isValidKiller(_killer2)) {
+          _nextMove = _killer2;
+          return true;
+        }
+        break;
+      case GEN_QUIETS:
+        _moves->resize(_badCaptureCount);
+        _currHead = _badCaptureCount;
+        MoveGen::genLegalMoves(*_board, *_moves, MoveGen::QUIETS);
+        _scoreQuiets();
+        _stage = QUIETS;
+        break;
+      case QUIETS:
+        while (_currHead < _moves->size()) {
+          Move move = _pickBest();
+          if (!(move == _hashMove) && !(move == _killer1) && !(move == _killer2)) {
+            _nextMove = move;
+            return true;
+          }
+        }
+        _stage = BAD_CAPTURES;
+        break;
+      case BAD_CAPTURES:
+        if (_badCaptureHead < _badCaptureCount) {
+          _nextMove = _moves->at(_badCaptureHead++);
+          return true;
+        }
+        _stage = DONE;
+        break;
+      case DONE:
+        return false;
+    }
+  }
+}
+
+Move GeneralMovePicker::_pickBest() {
+  size_t bestIndex = _currHead;
   int bestScore = -INF;
 
   for (size_t i = _currHead; i < _moves->size(); i++) {
@@ -52,4 +145,25 @@ Move GeneralMovePicker::getNext() {
 
   std::swap(_moves->at(_currHead), _moves->at(bestIndex));
   return _moves->at(_currHead++);
-}
\ No newline at end of file
+}
+
+bool GeneralMovePicker::hasNext() {
+  if (!_hasNextMove) {
+    _hasNextMove = _findNext();
+  }
+  return _hasNextMove;
+}
+
+Move GeneralMovePicker::getNext() {
+  if (!hasNext()) {
+    return Move();
+  }
+
+  _hasNextMove = false;
+  _pickedQuiet = _stage == QUIETS;
+  return _nextMove;
+}
+
+bool GeneralMovePicker::pickedQuiet() const {
+  return _pickedQuiet;
+}
@@ -9,11 +9,19 @@
  * @brief MovePicker that returns moves in an optimal order for negamax search.
  * 
  * Specifically, the GeneralMovePicker returns moves in the following order:
- * - Hash move from the transposition table (if it exists)
- * - Captures sorted by MVV/LVA
+ * - Hash move from the transposition table (if it exists), or the move of
+ *   the previous iteration's principal variation on nodes along it
+ * - Captures sorted by MVV/LVA (except losing captures)
  * - Promotions
  * - Killer moves
  * - Quiet moves sorted by the history heuristic
+ * - Losing captures (according to static exchange evaluation) sorted by MVV/LVA
+ *
+ * Moves are picked in stages, and each stage is only started once all moves
+ * from the previous stage have been picked. The hash move and killer moves are
+ * checked for legality directly, while captures (including promotions) and
+ * quiet moves are each generated into the provided MoveList as they are
+ * needed. If a search cuts off on the hash move, no moves are generated at all.
  */
 class GeneralMovePicker : MovePicker {
  public:
@@ -22,18 +30,26 @@ class GeneralMovePicker : MovePicker {
    *  
    * @param orderingInfo OrderingInfo object containing information about the current state of the search
    * @param board Current board state for all moves in the provided MoveList
-   * @param moveList Pointer to the MoveList to pick moves from
+   * @param moveList Pointer to the MoveList that moves are generated into (any existing moves are discarded)
    */
   GeneralMovePicker(const OrderingInfo *, const Board *, MoveList *);
 
-  bool hasNext() const override;
+  /**
+   * @brief Returns true if there are more moves to be picked.
+   *
+   * This may start the next stage of move picking (and generate its moves)
+   * if all moves of the current stage have been picked.
+   *
+   * @return true if there are more moves to be picked, false otherwise
+   */
+  bool hasNext() override;
 
   /**
    * @brief Returns the next best move in this GeneralMovePicker's MoveList for negamax search.
    * 
    * Note that internally, this method performs a selection sort for one unpicked move of the
-   * highest value in this GeneralMovePicker's internal MoveList and thus has time complexity
-   * O(n) with respect to the size of the MoveList. Provided move ordering is close to optimal though,
+   * highest value in the current stage and thus has time complexity O(n) with respect to the
+   * number of moves in the stage. Provided move ordering is close to optimal though,
    * this should be the optimal behaviour as negamax search should hit a beta cutoff after a small
    * number of good moves.
    * 
@@ -41,18 +57,124 @@ class GeneralMovePicker : MovePicker {
    */
   Move getNext() override;
 
+  /**
+   * @brief Returns true if the last move returned by getNext() was picked in
+   * the history ordered quiet move stage.
+   *
+   * These are the moves picked after the hash move, captures, promotions and
+   * killer moves, which makes them candidates for late move reductions.
+   *
+   * @return true if the last picked move was a history ordered quiet move, false otherwise
+   */
+  bool pickedQuiet() const;
+
  private:
   /**
-   * @brief Assigns a value to each move in this GeneralMovePicker's MoveList representing desirability
-   * in a negamax search.
+   * @enum Stage
+   * @brief Stages of move picking, in the order they are performed.
+   */
+  enum Stage {
+    HASH_MOVE,
+    GEN_CAPTURES,
+    CAPTURES,
+    KILLER1,
+    KILLER2,
+    GEN_QUIETS,
+    QUIETS,
+    BAD_CAPTURES,
+    DONE
+  };
+
+  /**
+   * @brief Current stage of move picking
+   */
+  Stage _stage;
+
+  /**
+   * @brief Next move to be returned by getNext() (if _hasNextMove is set)
+   */
+  Move _nextMove;
+
+  /**
+   * @brief True if _nextMove has been found but not yet returned by getNext()
    */
-  void _scoreMoves();
+  bool _hasNextMove;
+
+  /**
+   * @brief True if the last move returned by getNext() was picked in the QUIETS stage
+   */
+  bool _pickedQuiet;
+
+  /**
+   * @name Moves picked outside of the generated stages
+   *
+   * These are skipped when picking generated captures and quiet moves.
+   *
+   * @{
+   */
+  Move _hashMove;
+  Move _killer1;
+  Move _killer2;
+  /**@}*/
+
+  /**
+   * @brief Advances through the stages of move picking until a move is found.
+   *
+   * @return true if a move was found and stored in _nextMove, false if there
+   * are no moves left.
+   */
+  bool _findNext();
+
+  /**
+   * @brief Picks the highest valued unpicked move of the current stage.
+   *
+   * @return The highest valued unpicked move of the current stage
+   */
+  Move _pickBest();
+
+  /**
+   * @brief Returns true if the given killer move should be picked in a killer stage.
+   *
+   * Killer moves come from other positions at the same ply, so they are only
+   * picked if they are quiet, have not already been picked as the hash move
+   * and are legal in the current position.
+   *
+   * @param killer Killer move to check
+   * @return true if the killer move should be picked, false otherwise
+   */
+  bool _isValidKiller(Move) const;
+
+  /**
+   * @name Functions assigning a value representing desirability in a
+   * negamax search to each move in the current stage.
+   *
+   * @{
+   */
+  void _scoreCaptures();
+  void _scoreQuiets();
+  /**@}*/
 
   /**
    * @brief Position of the first unpicked move in this GeneralMovePicker's MoveList
    */
   size_t _currHead;
 
+  /**
+   * @name Losing captures
+   *
+   * Losing captures found in the CAPTURES stage are moved to the start of the
+   * MoveList (positions [0, _badCaptureCount)), where they are kept while
+   * quiet moves are generated after them.
+   *
+   * - _badCaptureCount - Number of losing captures at the start of the MoveList
+   * - _badCaptureHead - Position of the next losing capture to pick in the BAD_CAPTURES stage
+   *
+   * @{
+   */
+  size_t _badCaptureCount;
+  size_t _badCaptureHead;
+  /**@}*/
+
   /**
    * @brief OrderingInfo object containing search related information used by this GeneralMovePicker
    */
@@ -1,16 +1,10 @@
 #include "uci.h"
 #include "attacks.h"
-#include "movepicker.h"
-#include "eval.h"
-#include "rays.h"
+#include "search.h"
 
 int main() {
-  Rays::init();
-  PSquareTable::init();
-  ZKey::init();
-  MovePicker::init();
   Attacks::init();
-  Eval::init();
+  Search::initLmrTable();
   Uci::init();
 
   Uci::start();
@@ -16,6 +16,11 @@ Move::Move(unsigned int from, unsigned int to, PieceType piece, unsigned int fla
   _value = 0;
 }
 
+Move::Move(unsigned int move) {
+  _move = move;
+  _value = 0;
+}
+
 PieceType Move::getPieceType() const {
   return static_cast<PieceType>(_move & 0x7);
 }
@@ -54,6 +59,10 @@ unsigned int Move::getTo() const {
   return ((_move >> 15) & 0x3f);
 }
 
+unsigned int Move::getMoveInt() const {
+  return _move;
+}
+
 unsigned int Move::getFlags() const {
   return ((_move >> 21) & 0x7f);
 }
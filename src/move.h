@@ -26,6 +26,13 @@ class Move {
    */
   Move(unsigned int, unsigned int, PieceType, unsigned int= 0); // Non Null Move
 
+  /**
+   * @brief Construct a move from its packed integer representation.
+   *
+   * @param move Packed integer representation of a move as returned by getMoveInt()
+   */
+  explicit Move(unsigned int);
+
   /**
    * @enum Flag
    * @brief Flags that indicate special moves.
@@ -134,6 +141,16 @@ class Move {
    */
   unsigned int getTo() const;
 
+  /**
+   * @brief Returns the packed integer representation of this move.
+   *
+   * The returned value contains all information about this move except for
+   * its value (see getValue()) and fits in 28 bits.
+   *
+   * @return The packed integer representation of this move
+   */
+  unsigned int getMoveInt() const;
+
   /**
    * @brief Return a UCI compliant string representation of this move.
    * @return A UCI compliant string representation of this move.
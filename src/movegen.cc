@@ -1,34 +1,73 @@
 #include "movegen.h"
 #include "eval.h"
+#include "attacks.h"
+#include "rays.h"
+#include <algorithm>
+
+namespace {
+/**
+ * @brief Compile time constants for generating the moves of the given color.
+ *
+ * Square offsets are relative to the little endian rank file mapping, so
+ * white pawns move in the positive direction and black pawns in the negative
+ * direction.
+ */
+template<Color color>
+struct ColorTraits {
+  static constexpr Color THEM = color == WHITE ? BLACK : WHITE;
+
+  static constexpr int PUSH = color == WHITE ? 8 : -8;
+  static constexpr int LEFT_ATTACK = color == WHITE ? 7 : -9;
+  static constexpr int RIGHT_ATTACK = color == WHITE ? 9 : -7;
+
+  static constexpr U64 DOUBLE_PUSH_RANK = color == WHITE ? RANK_4 : RANK_5;
+  static constexpr U64 PROMOTION_RANK = color == WHITE ? RANK_8 : RANK_1;
+
+  static constexpr int KING_START = color == WHITE ? e1 : e8;
+  static constexpr int KSIDE_CASTLE_TO = color == WHITE ? g1 : g8;
+  static constexpr int QSIDE_CASTLE_TO = color == WHITE ? c1 : c8;
+};
+
+/**
+ * @brief Shifts all set bits in the given bitboard by the given square offset.
+ */
+template<int offset>
+inline U64 shift(U64 board) {
+  return offset > 0 ? board << (offset & 63) : board >> (-offset & 63);
+}
+
+/**
+ * @brief Returns the file that bits shifted by the given (diagonal) offset
+ * wrap around onto from the opposite edge of the board.
+ */
+constexpr U64 wrappedFile(int offset) {
+  return (offset == 7 || offset == -9) ? FILE_H : FILE_A;
+}
+}
 
 MoveGen::MoveGen(const Board &board) {
   setBoard(board);
 }
 
-MoveGen::MoveGen() {
-  setBoard(Board());
-}
+MoveGen::MoveGen() : _moveList(nullptr), _genCaptures(true), _genQuiets(true), _genEvasions(false), _board(nullptr),
+                     _pseudoLegalGenerated(false) {}
 
 void MoveGen::setBoard(const Board &board) {
-  _moves = MoveList();
-  _legalMoves = MoveList();
-  _genMoves(board);
+  _board = &board;
+  _moves.clear();
+  _legalMoves.clear();
+  _pseudoLegalGenerated = false;
+  _genLegalMoves(board, _legalMoves, ALL);
 }
 
-void MoveGen::_genLegalMoves(const Board &board) {
-  _legalMoves.reserve(_moves.size());
-  for (auto move : _moves) {
-    Board tempBoard = board;
-    tempBoard.doMove(move);
-
-    // Skip adding this move if it results in moving into check
-    if (!tempBoard.colorIsInCheck(tempBoard.getInactivePlayer())) {
-      _legalMoves.push_back(move);
-    }
+MoveList MoveGen::getMoves() {
+  // Pseudo-legal moves are only needed rarely, so only generate them on demand
+  if (!_pseudoLegalGenerated && _board) {
+    _clearLegalityMasks();
+    _genMoves(*_board, _moves, ALL);
+    _pseudoLegalGenerated = true;
   }
-}
 
-MoveList MoveGen::getMoves() {
   return _moves;
 }
 
@@ -36,279 +75,361 @@ MoveList MoveGen::getLegalMoves() {
   return _legalMoves;
 }
 
-void MoveGen::_genMoves(const Board &board) {
-  _moves.reserve(MOVELIST_RESERVE_SIZE);
-  switch (board.getActivePlayer()) {
-    case WHITE: _genWhiteMoves(board);
+void MoveGen::genLegalMoves(const Board &board, MoveList &moves, GenType genType) {
+  MoveGen movegen;
+  movegen._genLegalMoves(board, moves, genType);
+}
+
+bool MoveGen::isLegal(const Board &board, Move move) {
+  if (move.getFlags() & Move::NULL_MOVE) {
+    return false;
+  }
+
+  Color color = board.getActivePlayer();
+  PieceType pieceType = move.getPieceType();
+  U64 from = ONE << move.getFrom();
+  if (!(board.getPieces(color, pieceType) & from)) {
+    return false;
+  }
+
+  // Only generate the legal moves of the moving piece
+  MoveGen movegen;
+  MoveList moves;
+  movegen._setLegalityMasks(board);
+  movegen._moveList = &moves;
+
+  U64 attackable = board.getAttackable(board.getInactivePlayer());
+  switch (pieceType) {
+    case PAWN:
+      if (color == WHITE) {
+        movegen._genPawnMoves<WHITE>(board, from, movegen._getMoveMask(move.getFrom()));
+      } else {
+        movegen._genPawnMoves<BLACK>(board, from, movegen._getMoveMask(move.getFrom()));
+      }
+      break;
+    case KING:
+      if (color == WHITE) {
+        movegen._genKingMoves<WHITE>(board);
+      } else {
+        movegen._genKingMoves<BLACK>(board);
+      }
       break;
-    case BLACK: _genBlackMoves(board);
+    case KNIGHT: movegen._genKnightMoves(board, from, attackable);
+      break;
+    case BISHOP: movegen._genBishopMoves(board, from, attackable);
+      break;
+    case ROOK: movegen._genRookMoves(board, from, attackable);
+      break;
+    case QUEEN: movegen._genQueenMoves(board, from, attackable);
       break;
   }
-  _genLegalMoves(board);
-}
 
-void MoveGen::_genWhiteMoves(const Board &board) {
-  _genWhitePawnMoves(board);
-  _genWhiteRookMoves(board);
-  _genWhiteKnightMoves(board);
-  _genWhiteBishopMoves(board);
-  _genWhiteKingMoves(board);
-  _genWhiteQueenMoves(board);
+  return std::find(moves.begin(), moves.end(), move) != moves.end();
 }
 
-void MoveGen::_genBlackMoves(const Board &board) {
-  _genBlackPawnMoves(board);
-  _genBlackRookMoves(board);
-  _genBlackKnightMoves(board);
-  _genBlackBishopMoves(board);
-  _genBlackKingMoves(board);
-  _genBlackQueenMoves(board);
-}
+bool MoveGen::hasLegalMoves(const Board &board) {
+  MoveGen movegen;
+  MoveList moves;
+  movegen._setLegalityMasks(board);
+  movegen._moveList = &moves;
+  movegen._genCaptures = true;
+  movegen._genQuiets = true;
+  movegen._genEvasions = false;
 
-void MoveGen::_genPawnPromotions(unsigned int from, unsigned int to, unsigned int flags, PieceType capturedPieceType) {
-  Move promotionBase = Move(from, to, PAWN, flags | Move::PROMOTION);
-  if (flags & Move::CAPTURE) {
-    promotionBase.setCapturedPieceType(capturedPieceType);
-  }
+  return board.getActivePlayer() == WHITE ? movegen._hasMoves<WHITE>(board) : movegen._hasMoves<BLACK>(board);
+}
 
-  Move queenPromotion = promotionBase;
-  queenPromotion.setPromotionPieceType(QUEEN);
-  _moves.push_back(queenPromotion);
+void MoveGen::_genLegalMoves(const Board &board, MoveList &moves, GenType genType) {
+  _setLegalityMasks(board);
+  _genMoves(board, moves, genType);
+}
 
-  Move rookPromotion = promotionBase;
-  rookPromotion.setPromotionPieceType(ROOK);
-  _moves.push_back(rookPromotion);
+void MoveGen::_genMoves(const Board &board, MoveList &moves, GenType genType) {
+  _moveList = &moves;
+  _genCaptures = genType != QUIETS;
+  _genQuiets = genType != CAPTURES;
+  _genEvasions = genType == EVASIONS;
 
-  Move bishopPromotion = promotionBase;
-  bishopPromotion.setPromotionPieceType(BISHOP);
-  _moves.push_back(bishopPromotion);
+  switch (board.getActivePlayer()) {
+    case WHITE: _genMoves<WHITE>(board);
+      break;
+    case BLACK: _genMoves<BLACK>(board);
+      break;
+  }
+}
 
-  Move knightPromotion = promotionBase;
-  knightPromotion.setPromotionPieceType(KNIGHT);
-  _moves.push_back(knightPromotion);
+void MoveGen::_clearLegalityMasks() {
+  _onlyLegal = false;
+  _kingSquare = -1;
+  _checkers = ZERO;
+  _checkMask = ~ZERO;
+  _pinned = ZERO;
 }
 
-void MoveGen::_genWhitePawnSingleMoves(const Board &board) {
-  U64 movedPawns = board.getPieces(WHITE, PAWN) << 8;
-  movedPawns &= board.getNotOccupied();
+void MoveGen::_setLegalityMasks(const Board &board) {
+  _clearLegalityMasks();
+  _onlyLegal = true;
 
-  U64 promotions = movedPawns & RANK_8;
-  movedPawns &= ~RANK_8;
+  Color us = board.getActivePlayer();
+  Color them = board.getInactivePlayer();
 
-  // Generate single non promotion moves
-  while (movedPawns) {
-    int to = _popLsb(movedPawns);
-    _moves.push_back(Move(to - 8, to, PAWN));
+  U64 king = board.getPieces(us, KING);
+  if (!king) {
+    return;
   }
+  _kingSquare = _bitscanForward(king);
 
-  // Generate promotions
-  while (promotions) {
-    int to = _popLsb(promotions);
-    _genPawnPromotions(to - 8, to);
+  // Only king moves are legal in double check, otherwise non king moves must
+  // capture the checking piece or block its attack
+  _checkers = _getAttackers(board, them, _kingSquare, board.getOccupied());
+  if (_checkers) {
+    if (_checkers & (_checkers - 1)) {
+      _checkMask = ZERO;
+    } else {
+      _checkMask = _checkers | Rays::getBetween(_kingSquare, _bitscanForward(_checkers));
+    }
   }
-}
 
-void MoveGen::_genWhitePawnDoubleMoves(const Board &board) {
-  U64 singlePushes = (board.getPieces(WHITE, PAWN) << 8) & board.getNotOccupied();
-  U64 doublePushes = (singlePushes << 8) & board.getNotOccupied() & RANK_4;
+  // A piece is pinned if it is the only piece between our king and an enemy slider
+  U64 rooksQueens = board.getPieces(them, ROOK) | board.getPieces(them, QUEEN);
+  U64 bishopsQueens = board.getPieces(them, BISHOP) | board.getPieces(them, QUEEN);
+  U64 snipers = (Attacks::getSlidingAttacks(ROOK, _kingSquare, ZERO) & rooksQueens) |
+      (Attacks::getSlidingAttacks(BISHOP, _kingSquare, ZERO) & bishopsQueens);
 
-  while (doublePushes) {
-    int to = _popLsb(doublePushes);
-    _moves.push_back(Move(to - 16, to, PAWN, Move::DOUBLE_PAWN_PUSH));
+  while (snipers) {
+    int sniperSquare = _popLsb(snipers);
+    U64 blockers = Rays::getBetween(_kingSquare, sniperSquare) & board.getOccupied();
+
+    if (blockers && !(blockers & (blockers - 1))) {
+      _pinned |= blockers & board.getAllPieces(us);
+    }
   }
 }
 
-void MoveGen::_genWhitePawnLeftAttacks(const Board &board) {
-  U64 leftRegularAttacks = (board.getPieces(WHITE, PAWN) << 7) & board.getAttackable(BLACK) & ~FILE_H;
+U64 MoveGen::_getAttackers(const Board &board, Color color, int square, U64 occupied) const {
+  Color defender = getOppositeColor(color);
 
-  U64 leftAttackPromotions = leftRegularAttacks & RANK_8;
-  leftRegularAttacks &= ~RANK_8;
+  U64 rooksQueens = board.getPieces(color, ROOK) | board.getPieces(color, QUEEN);
+  U64 bishopsQueens = board.getPieces(color, BISHOP) | board.getPieces(color, QUEEN);
 
-  U64 leftEnPassant = (board.getPieces(WHITE, PAWN) << 7) & board.getEnPassant() & ~FILE_H;
+  return (Attacks::getNonSlidingAttacks(PAWN, square, defender) & board.getPieces(color, PAWN)) |
+      (Attacks::getNonSlidingAttacks(KNIGHT, square) & board.getPieces(color, KNIGHT)) |
+      (Attacks::getNonSlidingAttacks(KING, square) & board.getPieces(color, KING)) |
+      (Attacks::getSlidingAttacks(ROOK, square, occupied) & rooksQueens) |
+      (Attacks::getSlidingAttacks(BISHOP, square, occupied) & bishopsQueens);
+}
 
-  // Add regular attacks (Not promotions or en passants)
-  while (leftRegularAttacks) {
-    int to = _popLsb(leftRegularAttacks);
+U64 MoveGen::_getMoveMask(int from) const {
+  if (_pinned & (ONE << from)) {
+    return _checkMask & Rays::getLine(_kingSquare, from);
+  }
+  return _checkMask;
+}
 
-    Move move = Move(to - 7, to, PAWN, Move::CAPTURE);
-    move.setCapturedPieceType(board.getPieceAtSquare(BLACK, to));
+U64 MoveGen::_getGenTypeMask(U64 attackable) const {
+  return (_genCaptures ? attackable : ZERO) | (_genQuiets ? ~attackable : ZERO);
+}
 
-    _moves.push_back(move);
+bool MoveGen::_isLegalEnPassant(const Board &board, int from, int to, int capturedSquare) const {
+  if (!_onlyLegal || _kingSquare == -1) {
+    return true;
   }
 
-  // Add promotion attacks
-  while (leftAttackPromotions) {
-    int to = _popLsb(leftAttackPromotions);
-    _genPawnPromotions(to - 7, to, Move::CAPTURE, board.getPieceAtSquare(BLACK, to));
-  }
+  // En passant removes two pieces from the same rank at once, so pins and
+  // discovered checks are tested directly using the resulting occupancy
+  U64 captured = ONE << capturedSquare;
+  U64 occupied = (board.getOccupied() ^ (ONE << from) ^ captured) | (ONE << to);
 
-  // Add en passant attacks
-  // There can only be one en passant square at a time, so no need for loop
-  if (leftEnPassant) {
-    int to = _popLsb(leftEnPassant);
-    _moves.push_back(Move(to - 7, to, PAWN, Move::EN_PASSANT));
+  U64 attackers = _getAttackers(board, board.getInactivePlayer(), _kingSquare, occupied) & ~captured;
+  return !attackers;
+}
+
+template<Color color>
+void MoveGen::_genMoves(const Board &board) {
+  // Only the king can move out of double check
+  if (_genEvasions && (_checkers & (_checkers - 1))) {
+    _genKingMoves<color>(board);
+    return;
   }
+
+  U64 attackable = board.getAttackable(ColorTraits<color>::THEM);
+
+  _genPawnMoves<color>(board);
+  _genRookMoves(board, board.getPieces(color, ROOK), attackable);
+  _genKnightMoves(board, board.getPieces(color, KNIGHT), attackable);
+  _genBishopMoves(board, board.getPieces(color, BISHOP), attackable);
+  _genKingMoves<color>(board);
+  _genQueenMoves(board, board.getPieces(color, QUEEN), attackable);
 }
 
-void MoveGen::_genWhitePawnRightAttacks(const Board &board) {
-  U64 rightRegularAttacks = (board.getPieces(WHITE, PAWN) << 9) & board.getAttackable(BLACK) & ~FILE_A;
+template<Color color>
+bool MoveGen::_hasMoves(const Board &board) {
+  U64 attackable = board.getAttackable(ColorTraits<color>::THEM);
 
-  U64 rightAttackPromotions = rightRegularAttacks & RANK_8;
-  rightRegularAttacks &= ~RANK_8;
+  _genKingMoves<color>(board);
+  if (!_moveList->empty()) return true;
 
-  U64 rightEnPassant = (board.getPieces(WHITE, PAWN) << 9) & board.getEnPassant() & ~FILE_A;
+  _genPawnMoves<color>(board);
+  if (!_moveList->empty()) return true;
 
-  // Add regular attacks (Not promotions or en passants)
-  while (rightRegularAttacks) {
-    int to = _popLsb(rightRegularAttacks);
+  _genKnightMoves(board, board.getPieces(color, KNIGHT), attackable);
+  if (!_moveList->empty()) return true;
 
-    Move move = Move(to - 9, to, PAWN, Move::CAPTURE);
-    move.setCapturedPieceType(board.getPieceAtSquare(BLACK, to));
+  _genBishopMoves(board, board.getPieces(color, BISHOP), attackable);
+  if (!_moveList->empty()) return true;
 
-    _moves.push_back(move);
-  }
+  _genRookMoves(board, board.getPieces(color, ROOK), attackable);
+  if (!_moveList->empty()) return true;
 
-  // Add promotion attacks
-  while (rightAttackPromotions) {
-    int to = _popLsb(rightAttackPromotions);
-    _genPawnPromotions(to - 9, to, Move::CAPTURE, board.getPieceAtSquare(BLACK, to));
-  }
+  _genQueenMoves(board, board.getPieces(color, QUEEN), attackable);
+  return !_moveList->empty();
+}
 
-  // Add en passant attacks
-  // There can only be one en passant square at a time, so no need for loop
-  if (rightEnPassant) {
-    int to = _popLsb(rightEnPassant);
-    _moves.push_back(Move(to - 9, to, PAWN, Move::EN_PASSANT));
+void MoveGen::_genPawnPromotions(unsigned int from, unsigned int to, unsigned int flags, PieceType capturedPieceType) {
+  Move promotionBase = Move(from, to, PAWN, flags | Move::PROMOTION);
+  if (flags & Move::CAPTURE) {
+    promotionBase.setCapturedPieceType(capturedPieceType);
   }
+
+  Move queenPromotion = promotionBase;
+  queenPromotion.setPromotionPieceType(QUEEN);
+  _moveList->push_back(queenPromotion);
+
+  Move rookPromotion = promotionBase;
+  rookPromotion.setPromotionPieceType(ROOK);
+  _moveList->push_back(rookPromotion);
+
+  Move bishopPromotion = promotionBase;
+  bishopPromotion.setPromotionPieceType(BISHOP);
+  _moveList->push_back(bishopPromotion);
+
+  Move knightPromotion = promotionBase;
+  knightPromotion.setPromotionPieceType(KNIGHT);
+  _moveList->push_back(knightPromotion);
 }
 
-void MoveGen::_genBlackPawnSingleMoves(const Board &board) {
-  U64 movedPawns = board.getPieces(BLACK, PAWN) >> 8;
-  movedPawns &= board.getNotOccupied();
+template<Color color>
+void MoveGen::_genPawnSingleMoves(const Board &board, U64 pawns, U64 targets) {
+  typedef ColorTraits<color> Traits;
 
-  U64 promotions = movedPawns & RANK_1;
-  movedPawns &= ~RANK_1;
+  U64 movedPawns = shift<Traits::PUSH>(pawns);
+  movedPawns &= board.getNotOccupied() & targets;
 
-  // Generate single non promotion moves'
+  U64 promotions = _genCaptures ? movedPawns & Traits::PROMOTION_RANK : ZERO;
+  movedPawns &= _genQuiets ? ~Traits::PROMOTION_RANK : ZERO;
+
+  // Generate single non promotion moves
   while (movedPawns) {
     int to = _popLsb(movedPawns);
-    _moves.push_back(Move(to + 8, to, PAWN));
+    _moveList->push_back(Move(to - Traits::PUSH, to, PAWN));
   }
 
   // Generate promotions
   while (promotions) {
     int to = _popLsb(promotions);
-    _genPawnPromotions(to + 8, to);
+    _genPawnPromotions(to - Traits::PUSH, to);
   }
 }
 
-void MoveGen::_genBlackPawnDoubleMoves(const Board &board) {
-  U64 singlePushes = (board.getPieces(BLACK, PAWN) >> 8) & board.getNotOccupied();
-  U64 doublePushes = (singlePushes >> 8) & board.getNotOccupied() & RANK_5;
+template<Color color>
+void MoveGen::_genPawnDoubleMoves(const Board &board, U64 pawns, U64 targets) {
+  typedef ColorTraits<color> Traits;
+
+  if (!_genQuiets) {
+    return;
+  }
+
+  U64 singlePushes = shift<Traits::PUSH>(pawns) & board.getNotOccupied();
+  U64 doublePushes = shift<Traits::PUSH>(singlePushes) & board.getNotOccupied() & Traits::DOUBLE_PUSH_RANK & targets;
 
   while (doublePushes) {
     int to = _popLsb(doublePushes);
-    _moves.push_back(Move(to + 16, to, PAWN, Move::DOUBLE_PAWN_PUSH));
+    _moveList->push_back(Move(to - 2 * Traits::PUSH, to, PAWN, Move::DOUBLE_PAWN_PUSH));
   }
 }
 
-void MoveGen::_genBlackPawnLeftAttacks(const Board &board) {
-  U64 leftRegularAttacks = (board.getPieces(BLACK, PAWN) >> 9) & board.getAttackable(WHITE) & ~FILE_H;
-
-  U64 leftAttackPromotions = leftRegularAttacks & RANK_1;
-  leftRegularAttacks &= ~RANK_1;
-
-  U64 leftEnPassant = (board.getPieces(BLACK, PAWN) >> 9) & board.getEnPassant() & ~FILE_H;
-
-  // Add regular attacks (Not promotions or en passants)
-  while (leftRegularAttacks) {
-    int to = _popLsb(leftRegularAttacks);
-
-    Move move = Move(to + 9, to, PAWN, Move::CAPTURE);
-    move.setCapturedPieceType(board.getPieceAtSquare(WHITE, to));
-
-    _moves.push_back(move);
-  }
+template<Color color, int offset>
+void MoveGen::_genPawnAttacks(const Board &board, U64 pawns, U64 targets) {
+  typedef ColorTraits<color> Traits;
 
-  // Add promotion attacks
-  while (leftAttackPromotions) {
-    int to = _popLsb(leftAttackPromotions);
-    _genPawnPromotions(to + 9, to, Move::CAPTURE, board.getPieceAtSquare(WHITE, to));
+  if (!_genCaptures) {
+    return;
   }
 
-  // Add en passant attacks
-  // There can only be one en passant square at a time, so no need for loop
-  if (leftEnPassant) {
-    int to = _popLsb(leftEnPassant);
-    _moves.push_back(Move(to + 9, to, PAWN, Move::EN_PASSANT));
-  }
-}
+  U64 attacks = shift<offset>(pawns) & ~wrappedFile(offset);
 
-void MoveGen::_genBlackPawnRightAttacks(const Board &board) {
-  U64 rightRegularAttacks = (board.getPieces(BLACK, PAWN) >> 7) & board.getAttackable(WHITE) & ~FILE_A;
+  U64 regularAttacks = attacks & board.getAttackable(Traits::THEM) & targets;
 
-  U64 rightAttackPromotions = rightRegularAttacks & RANK_1;
-  rightRegularAttacks &= ~RANK_1;
+  U64 attackPromotions = regularAttacks & Traits::PROMOTION_RANK;
+  regularAttacks &= ~Traits::PROMOTION_RANK;
 
-  U64 rightEnPassant = (board.getPieces(BLACK, PAWN) >> 7) & board.getEnPassant() & ~FILE_A;
+  U64 enPassant = attacks & board.getEnPassant();
 
   // Add regular attacks (Not promotions or en passants)
-  while (rightRegularAttacks) {
-    int to = _popLsb(rightRegularAttacks);
+  while (regularAttacks) {
+    int to = _popLsb(regularAttacks);
 
-    Move move = Move(to + 7, to, PAWN, Move::CAPTURE);
-    move.setCapturedPieceType(board.getPieceAtSquare(WHITE, to));
+    Move move = Move(to - offset, to, PAWN, Move::CAPTURE);
+    move.setCapturedPieceType(board.getPieceAtSquare(Traits::THEM, to));
 
-    _moves.push_back(move);
+    _moveList->push_back(move);
   }
 
   // Add promotion attacks
-  while (rightAttackPromotions) {
-    int to = _popLsb(rightAttackPromotions);
-    _genPawnPromotions(to + 7, to, Move::CAPTURE, board.getPieceAtSquare(WHITE, to));
+  while (attackPromotions) {
+    int to = _popLsb(attackPromotions);
+    _genPawnPromotions(to - offset, to, Move::CAPTURE, board.getPieceAtSquare(Traits::THEM, to));
   }
 
   // Add en passant attacks
   // There can only be one en passant square at a time, so no need for loop
-  if (rightEnPassant) {
-    int to = _popLsb(rightEnPassant);
-    _moves.push_back(Move(to + 7, to, PAWN, Move::EN_PASSANT));
+  if (enPassant) {
+    int to = _popLsb(enPassant);
+    if (_isLegalEnPassant(board, to - offset, to, to - Traits::PUSH)) {
+      _moveList->push_back(Move(to - offset, to, PAWN, Move::EN_PASSANT));
+    }
   }
 }
 
-void MoveGen::_genWhitePawnMoves(const Board &board) {
-  _genWhitePawnSingleMoves(board);
-  _genWhitePawnDoubleMoves(board);
-  _genWhitePawnLeftAttacks(board);
-  _genWhitePawnRightAttacks(board);
-}
+template<Color color>
+void MoveGen::_genPawnMoves(const Board &board) {
+  U64 pawns = board.getPieces(color, PAWN);
 
-void MoveGen::_genBlackPawnMoves(const Board &board) {
-  _genBlackPawnSingleMoves(board);
-  _genBlackPawnDoubleMoves(board);
-  _genBlackPawnLeftAttacks(board);
-  _genBlackPawnRightAttacks(board);
+  _genPawnMoves<color>(board, pawns & ~_pinned, _checkMask);
+
+  // Pinned pawns can only move along the line through their king
+  U64 pinnedPawns = pawns & _pinned;
+  while (pinnedPawns) {
+    int from = _popLsb(pinnedPawns);
+    _genPawnMoves<color>(board, ONE << from, _getMoveMask(from));
+  }
 }
 
-void MoveGen::_genWhiteKingMoves(const Board &board) {
-  _genKingMoves(board, board.getPieces(WHITE, KING), board.getAttackable(BLACK));
+template<Color color>
+void MoveGen::_genPawnMoves(const Board &board, U64 pawns, U64 targets) {
+  typedef ColorTraits<color> Traits;
 
-  if (board.whiteCanCastleKs()) {
-    _moves.push_back(Move(e1, g1, KING, Move::KSIDE_CASTLE));
-  }
-  if (board.whiteCanCastleQs()) {
-    _moves.push_back(Move(e1, c1, KING, Move::QSIDE_CASTLE));
-  }
+  _genPawnSingleMoves<color>(board, pawns, targets);
+  _genPawnDoubleMoves<color>(board, pawns, targets);
+  _genPawnAttacks<color, Traits::LEFT_ATTACK>(board, pawns, targets);
+  _genPawnAttacks<color, Traits::RIGHT_ATTACK>(board, pawns, targets);
 }
 
-void MoveGen::_genBlackKingMoves(const Board &board) {
-  _genKingMoves(board, board.getPieces(BLACK, KING), board.getAttackable(WHITE));
+template<Color color>
+void MoveGen::_genKingMoves(const Board &board) {
+  typedef ColorTraits<color> Traits;
+
+  _genKingMoves(board, board.getPieces(color, KING), board.getAttackable(Traits::THEM));
 
-  if (board.blackCanCastleKs()) {
-    _moves.push_back(Move(e8, g8, KING, Move::KSIDE_CASTLE));
+  if (!_genQuiets || _genEvasions) {
+    return;
+  }
+
+  if (color == WHITE ? board.whiteCanCastleKs() : board.blackCanCastleKs()) {
+    _moveList->push_back(Move(Traits::KING_START, Traits::KSIDE_CASTLE_TO, KING, Move::KSIDE_CASTLE));
   }
-  if (board.blackCanCastleQs()) {
-    _moves.push_back(Move(e8, c8, KING, Move::QSIDE_CASTLE));
+  if (color == WHITE ? board.whiteCanCastleQs() : board.blackCanCastleQs()) {
+    _moveList->push_back(Move(Traits::KING_START, Traits::QSIDE_CASTLE_TO, KING, Move::QSIDE_CASTLE));
   }
 }
 
@@ -319,92 +440,73 @@ void MoveGen::_genKingMoves(const Board &board, U64 king, U64 attackable) {
 
   int kingIndex = _bitscanForward(king);
 
-  U64 moves = board.getAttacksForSquare(KING, board.getActivePlayer(), kingIndex);
+  U64 moves = board.getAttacksForSquare(KING, board.getActivePlayer(), kingIndex) & _getGenTypeMask(attackable);
+
+  // Remove squares attacked by the opponent (ignoring our king so that it
+  // cannot step back along the line of a checking slider)
+  if (_onlyLegal) {
+    U64 occupied = board.getOccupied() ^ king;
+    U64 destinations = moves;
+    while (destinations) {
+      int to = _popLsb(destinations);
+      if (_getAttackers(board, board.getInactivePlayer(), to, occupied)) {
+        moves &= ~(ONE << to);
+      }
+    }
+  }
 
   _addMoves(board, kingIndex, KING, moves, attackable);
 }
 
-void MoveGen::_genWhiteKnightMoves(const Board &board) {
-  _genKnightMoves(board, board.getPieces(WHITE, KNIGHT), board.getAttackable(BLACK));
-}
-
-void MoveGen::_genBlackKnightMoves(const Board &board) {
-  _genKnightMoves(board, board.getPieces(BLACK, KNIGHT), board.getAttackable(WHITE));
-}
-
 void MoveGen::_genKnightMoves(const Board &board, U64 knights, U64 attackable) {
   while (knights) {
     int from = _popLsb(knights);
 
-    U64 moves = board.getAttacksForSquare(KNIGHT, board.getActivePlayer(), from);
+    U64 moves = board.getAttacksForSquare(KNIGHT, board.getActivePlayer(), from) & _getMoveMask(from);
 
     _addMoves(board, from, KNIGHT, moves, attackable);
   }
 }
 
-void MoveGen::_genWhiteBishopMoves(const Board &board) {
-  _genBishopMoves(board, board.getPieces(WHITE, BISHOP), board.getAttackable(BLACK));
-}
-
-void MoveGen::_genBlackBishopMoves(const Board &board) {
-  _genBishopMoves(board, board.getPieces(BLACK, BISHOP), board.getAttackable(WHITE));
-}
-
 void MoveGen::_genBishopMoves(const Board &board, U64 bishops, U64 attackable) {
   while (bishops) {
     int from = _popLsb(bishops);
 
-    U64 moves = board.getAttacksForSquare(BISHOP, board.getActivePlayer(), from);
+    U64 moves = board.getAttacksForSquare(BISHOP, board.getActivePlayer(), from) & _getMoveMask(from);
 
     _addMoves(board, from, BISHOP, moves, attackable);
   }
 }
 
-void MoveGen::_genWhiteRookMoves(const Board &board) {
-  _genRookMoves(board, board.getPieces(WHITE, ROOK), board.getAttackable(BLACK));
-}
-
-void MoveGen::_genBlackRookMoves(const Board &board) {
-  _genRookMoves(board, board.getPieces(BLACK, ROOK), board.getAttackable(WHITE));
-}
-
 void MoveGen::_genRookMoves(const Board &board, U64 rooks, U64 attackable) {
   while (rooks) {
     int from = _popLsb(rooks);
 
-    U64 moves = board.getAttacksForSquare(ROOK, board.getActivePlayer(), from);
+    U64 moves = board.getAttacksForSquare(ROOK, board.getActivePlayer(), from) & _getMoveMask(from);
 
     _addMoves(board, from, ROOK, moves, attackable);
   }
 }
 
-void MoveGen::_genWhiteQueenMoves(const Board &board) {
-  _genQueenMoves(board, board.getPieces(WHITE, QUEEN), board.getAttackable(BLACK));
-}
-
-void MoveGen::_genBlackQueenMoves(const Board &board) {
-  _genQueenMoves(board, board.getPieces(BLACK, QUEEN), board.getAttackable(WHITE));
-}
-
 void MoveGen::_genQueenMoves(const Board &board, U64 queens, U64 attackable) {
   while (queens) {
     int from = _popLsb(queens);
 
-    U64 moves = board.getAttacksForSquare(QUEEN, board.getActivePlayer(), from);
+    U64 moves = board.getAttacksForSquare(QUEEN, board.getActivePlayer(), from) & _getMoveMask(from);
 
     _addMoves(board, from, QUEEN, moves, attackable);
   }
 }
 
 void MoveGen::_addMoves(const Board &board, int from, PieceType pieceType, U64 moves, U64 attackable) {
-  // Ignore all moves/attacks to kings
-  moves &= ~(board.getPieces(board.getInactivePlayer(), KING));
+  // Ignore all moves/attacks to kings and moves not of the type being generated
+  moves &= ~(board.getPieces(board.getInactivePlayer(), KING)) & _getGenTypeMask(attackable);
 
   // Generate non attacks
   U64 nonAttacks = moves & ~attackable;
   while (nonAttacks) {
     int to = _popLsb(nonAttacks);
-    _moves.push_back(Move(from, to, pieceType));
+    _moveList->push_back(Move(from, to, pieceType));
   }
 
   // Generate attacks
@@ -415,6 +517,6 @@ void MoveGen::_addMoves(const Board &board, int from, PieceType pieceType, U64 m
     Move move(from, to, pieceType, Move::CAPTURE);
     move.setCapturedPieceType(board.getPieceAtSquare(board.getInactivePlayer(), to));
 
-    _moves.push_back(move);
+    _moveList->push_back(move);
   }
 }
@@ -3,17 +3,35 @@
 
 #include "board.h"
 #include "defs.h"
+#include "movelist.h"
 
 /**
- * @brief Vector of move objects
- */
-typedef std::vector<Move> MoveList;
-
-/**
- * @brief Pseudo-legal move generator.
+ * @brief Legal and pseudo-legal move generator.
+ *
+ * Legal moves are generated directly, without making each move to test it.
+ * The pieces giving check and the pieces pinned to the king are found once
+ * per position, and used to restrict the squares that each piece can move to.
+ * King moves are checked against the opponent's attacks and en passant
+ * captures (which can expose the king along a rank) are tested individually.
+ *
+ * Pseudo-legal moves are only generated if getMoves() is called.
+ *
+ * In performance sensitive code, genLegalMoves() should be used to generate
+ * legal moves directly into a caller owned MoveList.
  */
 class MoveGen {
  public:
+  /**
+   * @enum GenType
+   * @brief Types of moves that can be generated.
+   */
+  enum GenType {
+    ALL, /**< All moves */
+    CAPTURES, /**< Captures (including en passant) and promotions */
+    QUIETS, /**< All moves that are not captures or promotions */
+    EVASIONS /**< All moves, for a side to move that is in check */
+  };
+
   /**
    * @brief Constructs a new MoveGen and generates moves for the given board.
    *
@@ -29,6 +47,8 @@ class MoveGen {
   /**
    * @brief Sets the board for this MoveGen to the specified board and generates moves for it.
    *
+   * The board must outlive this MoveGen if getMoves() is going to be called.
+   *
    * @param board Board to set and generate moves for
    */
   void setBoard(const Board &board);
@@ -41,12 +61,46 @@ class MoveGen {
   MoveList getMoves();
 
   /**
-   * @brief Returns the subset of pseudo-legal moves that are legal.
+   * @brief Returns all legal moves for the current board.
    *
    * @return A MoveList of all legal moves that have been generated for the current board.
    */
   MoveList getLegalMoves();
 
+  /**
+   * @brief Generates legal moves of the given type for the given board into the given MoveList.
+   *
+   * @param board   Board to generate moves for
+   * @param moves   MoveList to add generated moves to
+   * @param genType Type of moves to generate
+   */
+  static void genLegalMoves(const Board &, MoveList &, GenType= ALL);
+
+  /**
+   * @brief Returns true if the given move is legal on the given board.
+   *
+   * Only the moves of the moving piece are generated, which makes this much
+   * cheaper than generating all legal moves (eg. for validating a move from
+   * the transposition table).
+   *
+   * @param board Board to check the move on
+   * @param move  Move to check
+   * @return true if the move is legal, false otherwise
+   */
+  static bool isLegal(const Board &, Move);
+
+  /**
+   * @brief Returns true if the side to move on the given board has at least one legal move.
+   *
+   * Moves are generated for one type of piece at a time, stopping as soon as
+   * a legal move is found, which is much cheaper than generating all legal
+   * moves when checking for checkmate or stalemate.
+   *
+   * @param board Board to check
+   * @return true if the side to move has a legal move, false otherwise
+   */
+  static bool hasLegalMoves(const Board &);
+
  private:
   /**
    * @brief A vector containing generated pseudo-legal moves
@@ -59,103 +113,174 @@ class MoveGen {
   MoveList _legalMoves;
 
   /**
-   * @brief Size of _moves to pre-reserve before generating moves.
-   *
-   * At the current time 218 seems to be an upper bound on the maximum number
-   * of moves from any one position.
+   * @brief MoveList that generated moves are currently being added to.
    */
-  static const int MOVELIST_RESERVE_SIZE = 218;
+  MoveList *_moveList;
 
   /**
-   * @brief Generates pseudo-legal moves for the active player of the given board
+   * @name Types of moves currently being generated (see MoveGen::GenType)
    *
-   * Generated pseudo-legal moves are stored in the _moves vector.
+   * - _genCaptures - True if captures and promotions are being generated
+   * - _genQuiets - True if quiet moves are being generated
+   * - _genEvasions - True if only check evasions are being generated (castling is skipped, as are
+   *   non king moves in double check)
    *
-   * @param board Board to generate moves for
+   * @{
    */
-  void _genMoves(const Board &board);
+  bool _genCaptures;
+  bool _genQuiets;
+  bool _genEvasions;
+  /**@}*/
 
   /**
-   * @brief Populates the _legalMoves vector with moves from _moves that are legal.
-   *
-   * @param board Board to check legality of moves with.
+   * @brief Board that moves are being generated for.
    */
-  void _genLegalMoves(const Board &board);
+  const Board *_board;
 
   /**
-   * @brief Convenience function to generate pawn promotions.
-   *
-   * Given the from square, to square, extra flags (if applicable) and a captured
-   * piece type (if this is a capture promotion), generate the 4 possible promotion moves
-   * (queen, rook, bishop, knight).
-   *
-   * @param from              From square (little endian rank-file mapping)
-   * @param to                To square (little endian rank-file mapping)
-   * @param flags             Extra move flags (if applicable)
-   * @param capturedPieceType Captured piece type (if applicable)
+   * @brief True if _moves has been populated with pseudo-legal moves.
    */
-  void _genPawnPromotions(unsigned int, unsigned int, unsigned int= 0, PieceType= PAWN);
+  bool _pseudoLegalGenerated;
 
   /**
-   * @name White/black move generation functions
+   * @name Legality masks
+   *
+   * Masks restricting the moves generated for the current board. When
+   * generating pseudo-legal moves, these masks allow every move.
    *
-   * These functions generate all pseudo-legal moves for black and white.
+   * - _onlyLegal - True if only legal moves should be generated
+   * - _kingSquare - Square of the king of the side to move (-1 if it has none)
+   * - _checkers - Pieces giving check to the king of the side to move
+   * - _checkMask - Squares that non king moves must move to (capturing the checking piece or blocking check)
+   * - _pinned - Pieces of the side to move that are pinned to their king
    *
    * @{
    */
-  void _genWhiteMoves(const Board &);
-  void _genBlackMoves(const Board &);
+  bool _onlyLegal;
+  int _kingSquare;
+  U64 _checkers;
+  U64 _checkMask;
+  U64 _pinned;
   /**@}*/
 
   /**
-   * @name Pseudo-legal move generation functions
+   * @brief Generates moves of the given type allowed by the current legality
+   * masks for the active player of the given board.
    *
-   * These functions generate pseudo-legal moves for their piece and color for the given board.
+   * Generated moves are added to the given MoveList.
    *
-   * @{
+   * @param board   Board to generate moves for
+   * @param moves   MoveList to add generated moves to
+   * @param genType Type of moves to generate
    */
-  void _genWhitePawnMoves(const Board &);
-  void _genBlackPawnMoves(const Board &);
+  void _genMoves(const Board &board, MoveList &moves, GenType genType);
 
-  void _genWhiteKingMoves(const Board &);
-  void _genBlackKingMoves(const Board &);
+  /**
+   * @brief Adds all legal moves of the given type for the given board to the given MoveList.
+   *
+   * @param board   Board to generate legal moves for.
+   * @param moves   MoveList to add generated moves to
+   * @param genType Type of moves to generate
+   */
+  void _genLegalMoves(const Board &board, MoveList &moves, GenType genType);
 
-  void _genWhiteKnightMoves(const Board &);
-  void _genBlackKnightMoves(const Board &);
+  /**
+   * @brief Sets the legality masks so that only legal moves will be generated
+   * for the given board.
+   *
+   * @param board Board to set legality masks for
+   */
+  void _setLegalityMasks(const Board &board);
 
-  void _genWhiteBishopMoves(const Board &);
-  void _genBlackBishopMoves(const Board &);
+  /**
+   * @brief Sets the legality masks so that all pseudo-legal moves will be generated.
+   */
+  void _clearLegalityMasks();
 
-  void _genWhiteRookMoves(const Board &);
-  void _genBlackRookMoves(const Board &);
+  /**
+   * @brief Returns a bitboard of the pieces of the given color attacking the
+   * given square, using the given occupancy for sliding pieces.
+   *
+   * @param board    Board to find attackers on
+   * @param color    Color of attacking pieces
+   * @param square   Square being attacked (little endian rank file mapping)
+   * @param occupied Occupancy to use for sliding piece attacks
+   * @return A bitboard of all pieces of the given color attacking the square
+   */
+  U64 _getAttackers(const Board &, Color, int, U64) const;
 
-  void _genWhiteQueenMoves(const Board &);
-  void _genBlackQueenMoves(const Board &);
-  /**@}*/
+  /**
+   * @brief Returns the squares a non king piece on the given square may move to
+   * under the current legality masks.
+   *
+   * @param from Square of the piece to move (little endian rank file mapping)
+   * @return A bitboard of squares the piece may move to
+   */
+  U64 _getMoveMask(int) const;
 
   /**
-   * @name White pawn pseudo-legal move generation functions
+   * @brief Returns a mask of the destination squares allowed for non pawn moves
+   * by the type of moves currently being generated.
    *
-   * These functions generate the four types of pawn moves for white for a given board.
-   * @{
+   * @param attackable Bitboard of attackable opponent pieces
+   * @return A mask of destination squares allowed by the current GenType
    */
-  void _genWhitePawnSingleMoves(const Board &);
-  void _genWhitePawnDoubleMoves(const Board &);
-  void _genWhitePawnRightAttacks(const Board &);
-  void _genWhitePawnLeftAttacks(const Board &);
-  /**@}*/
+  U64 _getGenTypeMask(U64) const;
+
+  /**
+   * @brief Returns true if the given en passant capture does not leave the
+   * moving side's king in check (or if only pseudo-legal moves are being generated).
+   *
+   * @param board          Board the capture is made on
+   * @param from           Square of the capturing pawn
+   * @param to             En passant target square
+   * @param capturedSquare Square of the captured pawn
+   * @return true if the en passant capture is allowed, false otherwise
+   */
+  bool _isLegalEnPassant(const Board &, int, int, int) const;
 
   /**
-   * @name Black pawn pseudo-legal generation functions
+   * @brief Convenience function to generate pawn promotions.
    *
-   * These functions generate the four types of pawn moves for black for a given board.
+   * Given the from square, to square, extra flags (if applicable) and a captured
+   * piece type (if this is a capture promotion), generate the 4 possible promotion moves
+   * (queen, rook, bishop, knight).
+   *
+   * @param from              From square (little endian rank-file mapping)
+   * @param to                To square (little endian rank-file mapping)
+   * @param flags             Extra move flags (if applicable)
+   * @param capturedPieceType Captured piece type (if applicable)
+   */
+  void _genPawnPromotions(unsigned int, unsigned int, unsigned int= 0, PieceType= PAWN);
+
+  /**
+   * @name Color templated move generation functions
+   *
+   * These functions generate pseudo-legal moves (restricted by the current
+   * legality masks) for the given color. The color is a template parameter so
+   * that pawn directions, promotion and double push ranks and castling squares
+   * are compile time constants. The active player is only tested once, when
+   * _genMoves() dispatches to _genMoves<color>().
+   *
+   * The pawn move functions taking bitboards generate moves for the given
+   * pawns to the given bitboard of allowed destination squares.
+   * _genPawnAttacks() generates captures in the direction of the given square
+   * offset. _hasMoves() generates moves one type of piece at a time until one
+   * is found (see hasLegalMoves()).
    *
    * @{
    */
-  void _genBlackPawnSingleMoves(const Board &);
-  void _genBlackPawnDoubleMoves(const Board &);
-  void _genBlackPawnRightAttacks(const Board &);
-  void _genBlackPawnLeftAttacks(const Board &);
+  template<Color color> void _genMoves(const Board &);
+  template<Color color> bool _hasMoves(const Board &);
+
+  template<Color color> void _genPawnMoves(const Board &);
+  template<Color color> void _genPawnMoves(const Board &, U64, U64);
+
+  template<Color color> void _genPawnSingleMoves(const Board &, U64, U64);
+  template<Color color> void _genPawnDoubleMoves(const Board &, U64, U64);
+  template<Color color, int offset> void _genPawnAttacks(const Board &, U64, U64);
+
+  template<Color color> void _genKingMoves(const Board &);
   /**@}*/
 
   /**
@@ -0,0 +1,133 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include "move.h"
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+/**
+ * @brief A fixed capacity list of moves.
+ *
+ * Moves are stored inline, so a MoveList never allocates memory on the heap and
+ * can be cheaply created on the stack at every node of a search. Only the moves
+ * that have been added are constructed or copied.
+ *
+ * MoveList supports the parts of the std::vector interface needed for move
+ * generation and move picking (push_back(), size(), at(), range based for
+ * loops etc.).
+ */
+class MoveList {
+ public:
+  /**
+   * @brief Maximum number of moves that can be stored in a MoveList.
+   *
+   * At the current time 218 seems to be an upper bound on the maximum number
+   * of moves from any one position.
+   */
+  static const int MAX_SIZE = 256;
+
+  /**
+   * @name Iterator types
+   *
+   * @{
+   */
+  typedef Move *iterator;
+  typedef const Move *const_iterator;
+  /**@}*/
+
+  /**
+   * @brief Constructs a new empty MoveList.
+   */
+  MoveList() : _size(0) {}
+
+  MoveList(const MoveList &other) : _size(other._size) {
+    std::copy(other.begin(), other.end(), begin());
+  }
+
+  MoveList &operator=(const MoveList &other) {
+    _size = other._size;
+    std::copy(other.begin(), other.end(), begin());
+    return *this;
+  }
+
+  /**
+   * @brief Adds the given move to the end of this MoveList.
+   *
+   * @param move Move to add
+   */
+  void push_back(const Move &move) {
+    new(&_storage[_size++]) Move(move);
+  }
+
+  /**
+   * @brief Removes all moves from this MoveList.
+   */
+  void clear() {
+    _size = 0;
+  }
+
+  /**
+   * @brief Removes moves from the end of this MoveList until it contains the given number of moves.
+   *
+   * @param count Number of moves to keep (must not be greater than size())
+   */
+  void resize(size_t count) {
+    _size = count;
+  }
+
+  /**
+   * @brief Returns the number of moves in this MoveList.
+   *
+   * @return The number of moves in this MoveList
+   */
+  size_t size() const {
+    return _size;
+  }
+
+  /**
+   * @brief Returns true if this MoveList contains no moves.
+   *
+   * @return true if this MoveList contains no moves, false otherwise
+   */
+  bool empty() const {
+    return _size == 0;
+  }
+
+  /**
+   * @name Element access
+   * @brief Returns the move at the given index (no bounds checking is performed).
+   *
+   * @{
+   */
+  Move &at(size_t index) { return begin()[index]; }
+  const Move &at(size_t index) const { return begin()[index]; }
+  Move &operator[](size_t index) { return begin()[index]; }
+  const Move &operator[](size_t index) const { return begin()[index]; }
+  /**@}*/
+
+  /**
+   * @name Iterators
+   *
+   * @{
+   */
+  iterator begin() { return reinterpret_cast<Move *>(_storage); }
+  iterator end() { return begin() + _size; }
+  const_iterator begin() const { return reinterpret_cast<const Move *>(_storage); }
+  const_iterator end() const { return begin() + _size; }
+  /**@}*/
+
+ private:
+  /**
+   * @brief Uninitialized storage for MAX_SIZE moves.
+   */
+  typename std::aligned_storage<sizeof(Move), alignof(Move)>::type _storage[MAX_SIZE];
+
+  /**
+   * @brief Number of moves in this MoveList.
+   */
+  size_t _size;
+};
+
+#endif
@@ -1,23 +1,41 @@
 #include "movepicker.h"
+#include "eval.h"
 
-// Indexed by [victimValue][attackerValue]
-int MovePicker::_mvvLvaTable[5][6];
+constexpr MovePicker::MvvLvaTable MovePicker::_makeMvvLvaTable() {
+  MvvLvaTable mvvLvaTable{};
 
-void MovePicker::init() {
   // Build the MVV LVA table
   int currScore = 0;
-  PieceType victimsLoToHi[] = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN};
-  PieceType attackersHiToLo[] = {KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN};
+  const PieceType victimsLoToHi[] = {PAWN, KNIGHT, BISHOP, ROOK, QUEEN};
+  const PieceType attackersHiToLo[] = {KING, QUEEN, ROOK, BISHOP, KNIGHT, PAWN};
 
   // Iterate over victims (low to high)
   for (auto victim : victimsLoToHi) {
     // Iterate over attackers (high to low)
     for (auto attacker : attackersHiToLo) {
-      _mvvLvaTable[victim][attacker] = currScore++;
+      mvvLvaTable[victim][attacker] = currScore++;
     }
   }
+
+  return mvvLvaTable;
 }
 
+// Indexed by [victimValue][attackerValue]
+constexpr MovePicker::MvvLvaTable MovePicker::_mvvLvaTable = MovePicker::_makeMvvLvaTable();
+
 MovePicker::MovePicker(MoveList *moveList) {
   _moves = moveList;
-}
\ No newline at end of file
+}
+
+bool MovePicker::isLosingCapture(const Board &board, Move move) {
+  if ((move.getFlags() & (Move::CAPTURE | Move::PROMOTION)) != Move::CAPTURE) {
+    return false;
+  }
+
+  if (Eval::getMaterialValue(move.getCapturedPieceType()) >= Eval::getMaterialValue(move.getPieceType())
+      && move.getPieceType() != KING) {
+    return false;
+  }
+
+  return board.see(move) < 0;
+}
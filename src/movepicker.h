@@ -33,25 +33,45 @@ class MovePicker {
    * 
    * @return true if there are more moves to be picked from this MovePicker's MoveList, false otherwise.
    */
-  virtual bool hasNext() const = 0;
+  virtual bool hasNext() = 0;
 
   /**
-   * @brief Initializes constants used in picking moves.
-   * 
-   * Currently this initialized the internal _mvvLvaTable array only.
+   * @brief Returns true if the given move is a capture that loses material
+   * according to static exchange evaluation (see Board::see()).
+   *
+   * Captures of pieces worth at least as much as the capturing piece (and
+   * capture promotions) are never losing, so the exchange is only evaluated
+   * for the other captures.
+   *
+   * @param board Board the move is made on
+   * @param move  Move to check
+   * @return true if the move is a losing capture, false otherwise
    */
-  static void init();
+  static bool isLosingCapture(const Board &, Move);
+
  protected:
   /**
    * @brief List of moves this MovePicker picks from
    */
   MoveList *_moves;
 
+  /**
+   * @brief Table indexed by [victimValue][attackerValue]
+   */
+  typedef Table<Table<int, 6>, 5> MvvLvaTable;
+
   /**
    * @brief Table mapping [victimValue][attackerValue] to an integer represnting move desirability
    * according to MVV/LVA.
    */
-  static int _mvvLvaTable[5][6];
+  static const MvvLvaTable _mvvLvaTable;
+
+  /**
+   * @brief Builds _mvvLvaTable at compile time.
+   *
+   * @return The MVV/LVA table
+   */
+  static constexpr MvvLvaTable _makeMvvLvaTable();
 
   /**
    * @brief Bonuses applied to specific move types.
@@ -0,0 +1,252 @@
+#include "nnue.h"
+#include "board.h"
+#include "bitutils.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#if !defined(NO_SIMD) && (defined(__AVX2__) || defined(__SSE4_1__))
+#include <immintrin.h>
+#endif
+
+namespace {
+/**
+ * @brief Currently loaded network (nullptr if none has been loaded).
+ */
+std::shared_ptr<const Nnue::Network> currentNetwork;
+
+/**
+ * @brief Guards currentNetwork, which may be replaced while searches are being set up.
+ */
+std::mutex networkMutex;
+
+/**
+ * @brief Returns the index of the input for the given piece from the given perspective.
+ */
+inline int featureIndex(Color perspective, Color color, PieceType pieceType, int square) {
+  if (perspective == BLACK) {
+    color = getOppositeColor(color);
+    square ^= 56;
+  }
+  return color * 384 + pieceType * 64 + square;
+}
+
+/**
+ * @name Accumulator and output layer kernels
+ * @brief These functions operate on arrays of Nnue::HIDDEN_SIZE values.
+ *
+ * HIDDEN_SIZE is a multiple of 16, so the vectorized versions don't need to
+ * handle leftover values. Unaligned loads and stores are used since
+ * accumulators are not guaranteed to be 32 byte aligned.
+ *
+ * @{
+ */
+#if !defined(NO_SIMD) && defined(__AVX2__)
+inline void addWeights(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i += 16) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(values + i), _mm256_add_epi16(v, w));
+  }
+}
+
+inline void subWeights(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i += 16) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(values + i), _mm256_sub_epi16(v, w));
+  }
+}
+
+inline int32_t clippedDot(const int16_t *values, const int16_t *weights) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i qa = _mm256_set1_epi16(Nnue::QA);
+  __m256i sum = _mm256_setzero_si256();
+
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i += 16) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+    __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+    v = _mm256_min_epi16(_mm256_max_epi16(v, zero), qa);
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, w));
+  }
+
+  __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  sum128 = _mm_hadd_epi32(sum128, sum128);
+  sum128 = _mm_hadd_epi32(sum128, sum128);
+  return _mm_cvtsi128_si32(sum128);
+}
+#elif !defined(NO_SIMD) && defined(__SSE4_1__)
+inline void addWeights(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+    __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(values + i), _mm_add_epi16(v, w));
+  }
+}
+
+inline void subWeights(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+    __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(values + i), _mm_sub_epi16(v, w));
+  }
+}
+
+inline int32_t clippedDot(const int16_t *values, const int16_t *weights) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i qa = _mm_set1_epi16(Nnue::QA);
+  __m128i sum = _mm_setzero_si128();
+
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i += 8) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+    __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+    v = _mm_min_epi16(_mm_max_epi16(v, zero), qa);
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(v, w));
+  }
+
+  sum = _mm_hadd_epi32(sum, sum);
+  sum = _mm_hadd_epi32(sum, sum);
+  return _mm_cvtsi128_si32(sum);
+}
+#else
+inline void addWeights(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i++) {
+    values[i] += weights[i];
+  }
+}
+
+inline void subWeights(int16_t *values, const int16_t *weights) {
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i++) {
+    values[i] -= weights[i];
+  }
+}
+
+inline int32_t clippedDot(const int16_t *values, const int16_t *weights) {
+  int32_t sum = 0;
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i++) {
+    sum += std::min(std::max(static_cast<int32_t>(values[i]), 0), Nnue::QA) * weights[i];
+  }
+  return sum;
+}
+#endif
+/**@}*/
+
+template<typename T>
+bool readValue(std::istream &stream, T &value) {
+  return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+}
+
+Nnue::AccumulatorStack::AccumulatorStack(std::shared_ptr<const Network> network) :
+    _network(network),
+    _stack(new Accumulator[MAX_SIZE]),
+    _top(0) {}
+
+void Nnue::AccumulatorStack::refresh(const Board &board) {
+  _top = 0;
+
+  for (auto perspective : {WHITE, BLACK}) {
+    std::memcpy(_stack[0].values[perspective], _network->featureBiases, sizeof(_network->featureBiases));
+  }
+
+  for (auto color : {WHITE, BLACK}) {
+    for (auto pieceType : {PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING}) {
+      U64 pieces = board.getPieces(color, pieceType);
+      while (pieces) {
+        addPiece(color, pieceType, _popLsb(pieces));
+      }
+    }
+  }
+}
+
+void Nnue::AccumulatorStack::push() {
+  assert(_top + 1 < MAX_SIZE);
+  _stack[_top + 1] = _stack[_top];
+  _top++;
+}
+
+void Nnue::AccumulatorStack::pop() {
+  assert(_top > 0);
+  _top--;
+}
+
+void Nnue::AccumulatorStack::addPiece(Color color, PieceType pieceType, int square) {
+  for (auto perspective : {WHITE, BLACK}) {
+    addWeights(_stack[_top].values[perspective],
+               _network->featureWeights[featureIndex(perspective, color, pieceType, square)]);
+  }
+}
+
+void Nnue::AccumulatorStack::removePiece(Color color, PieceType pieceType, int square) {
+  for (auto perspective : {WHITE, BLACK}) {
+    subWeights(_stack[_top].values[perspective],
+               _network->featureWeights[featureIndex(perspective, color, pieceType, square)]);
+  }
+}
+
+void Nnue::AccumulatorStack::movePiece(Color color, PieceType pieceType, int from, int to) {
+  removePiece(color, pieceType, from);
+  addPiece(color, pieceType, to);
+}
+
+const Nnue::Accumulator &Nnue::AccumulatorStack::top() const {
+  return _stack[_top];
+}
+
+const Nnue::Network &Nnue::AccumulatorStack::getNetwork() const {
+  return *_network;
+}
+
+std::shared_ptr<const Nnue::Network> Nnue::read(std::istream &stream) {
+  char magic[4];
+  uint32_t version, inputSize, hiddenSize;
+
+  if (!stream.read(magic, sizeof(magic)) || std::memcmp(magic, "SBNN", sizeof(magic)) != 0
+      || !readValue(stream, version) || version != FILE_VERSION
+      || !readValue(stream, inputSize) || inputSize != INPUT_SIZE
+      || !readValue(stream, hiddenSize) || hiddenSize != HIDDEN_SIZE) {
+    return nullptr;
+  }
+
+  std::shared_ptr<Network> network = std::make_shared<Network>();
+  if (!readValue(stream, network->featureWeights) || !readValue(stream, network->featureBiases)
+      || !readValue(stream, network->outputWeights) || !readValue(stream, network->outputBias)) {
+    return nullptr;
+  }
+
+  return network;
+}
+
+bool Nnue::load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  std::shared_ptr<const Network> loaded = read(file);
+  if (!loaded) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(networkMutex);
+  currentNetwork = loaded;
+  return true;
+}
+
+std::shared_ptr<const Nnue::Network> Nnue::getNetwork() {
+  std::lock_guard<std::mutex> lock(networkMutex);
+  return currentNetwork;
+}
+
+int Nnue::evaluate(const Board &board) {
+  const AccumulatorStack *accumulators = board.getAccumulators();
+  const Network &net = accumulators->getNetwork();
+  const Accumulator &accumulator = accumulators->top();
+
+  Color us = board.getActivePlayer();
+  Color them = board.getInactivePlayer();
+
+  int32_t output = clippedDot(accumulator.values[us], net.outputWeights[0])
+      + clippedDot(accumulator.values[them], net.outputWeights[1])
+      + net.outputBias;
+
+  return static_cast<int>(static_cast<int64_t>(output) * OUTPUT_SCALE / (QA * QB));
+}
@@ -0,0 +1,249 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "defs.h"
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+
+class Board;
+
+/**
+ * @brief Namespace containing the efficiently updatable neural network
+ * (NNUE) evaluation
+ *
+ * The network has a single hidden layer that is split into two halves, one
+ * seen from white's perspective and one from black's. Each half takes 768
+ * inputs (one for each color, piece type and square) and produces
+ * Nnue::HIDDEN_SIZE values. Because moves only change a few inputs, the
+ * hidden layer (the accumulator) is updated incrementally as moves are made
+ * instead of being recalculated at every node (see AccumulatorStack).
+ *
+ * The output is calculated from the accumulator of the side to move followed
+ * by the accumulator of the other side, each clipped to [0, Nnue::QA].
+ *
+ * The accumulator and output layer use AVX2 or SSE4.1 instructions if the
+ * engine is compiled for a CPU that supports them, or portable scalar code
+ * otherwise (or if NO_SIMD is defined).
+ *
+ * Network files are made up of (all values little endian):
+ * - The magic bytes "SBNN"
+ * - The format version (uint32, Nnue::FILE_VERSION)
+ * - The number of inputs and hidden values (uint32, must equal
+ *   Nnue::INPUT_SIZE and Nnue::HIDDEN_SIZE)
+ * - Hidden layer weights (int16, indexed by [input][hidden value])
+ * - Hidden layer biases (int16, indexed by [hidden value])
+ * - Output weights (int16, indexed by [perspective][hidden value] where the
+ *   side to move's perspective comes first)
+ * - The output bias (int32)
+ *
+ * Inputs from white's perspective are indexed by
+ * color * 384 + pieceType * 64 + square (using this engine's Color and
+ * PieceType values). Black's perspective uses the same layout with colors
+ * swapped and the board flipped vertically.
+ */
+namespace Nnue {
+/**
+ * @brief Number of network inputs for each perspective
+ */
+const int INPUT_SIZE = 768;
+
+/**
+ * @brief Number of hidden values for each perspective
+ */
+const int HIDDEN_SIZE = 256;
+
+/**
+ * @brief Quantization factor of the hidden layer (hidden values are clipped to [0, QA])
+ */
+const int QA = 255;
+
+/**
+ * @brief Quantization factor of the output weights
+ */
+const int QB = 64;
+
+/**
+ * @brief Factor used to convert the network output to centipawns
+ */
+const int OUTPUT_SCALE = 400;
+
+/**
+ * @brief Version of the network file format
+ */
+const uint32_t FILE_VERSION = 1;
+
+/**
+ * @brief Weights and biases of a network.
+ *
+ * Weights are expected to be small enough that the output layer's sums fit in
+ * 32 bits.
+ */
+struct Network {
+  int16_t featureWeights[INPUT_SIZE][HIDDEN_SIZE];
+  int16_t featureBiases[HIDDEN_SIZE];
+  int16_t outputWeights[2][HIDDEN_SIZE];
+  int32_t outputBias;
+};
+
+/**
+ * @brief Hidden layer values indexed by [perspective][hidden value].
+ */
+struct Accumulator {
+  int16_t values[2][HIDDEN_SIZE];
+};
+
+/**
+ * @brief A stack of accumulators, one for each ply of the line currently
+ * being searched.
+ *
+ * A Board with an attached AccumulatorStack (see Board::setAccumulators())
+ * pushes a copy of the top accumulator when a move is made, updates it with
+ * the inputs that the move added and removed, and pops it when the move is
+ * undone.
+ */
+class AccumulatorStack {
+ public:
+  /**
+   * @brief Maximum number of accumulators in an AccumulatorStack.
+   *
+   * Searches make at most MAX_PLY - 1 moves in the main search followed by
+   * MAX_QSEARCH_PLY moves in quiescence search, on top of the root accumulator.
+   */
+  static const int MAX_SIZE = MAX_PLY + MAX_QSEARCH_PLY;
+
+  /**
+   * @brief Constructs a new AccumulatorStack for the given network.
+   *
+   * @param network Network to calculate accumulators with
+   */
+  AccumulatorStack(std::shared_ptr<const Network>);
+
+  /**
+   * @brief Clears this stack and recalculates its only accumulator from scratch for the given board.
+   *
+   * @param board Board to calculate the accumulator for
+   */
+  void refresh(const Board &);
+
+  /**
+   * @brief Pushes a copy of the top accumulator onto this stack.
+   *
+   * At most MAX_SIZE accumulators may be on the stack.
+   */
+  void push();
+
+  /**
+   * @brief Removes the top accumulator from this stack.
+   */
+  void pop();
+
+  /**
+   * @name Accumulator update functions
+   * @brief Update the top accumulator for a piece being added, removed or moved.
+   *
+   * @{
+   */
+  void addPiece(Color, PieceType, int);
+  void removePiece(Color, PieceType, int);
+  void movePiece(Color, PieceType, int, int);
+  /**@}*/
+
+  /**
+   * @brief Returns the accumulator at the top of this stack.
+   *
+   * @return The accumulator at the top of this stack
+   */
+  const Accumulator &top() const;
+
+  /**
+   * @brief Returns the network used by this stack.
+   *
+   * @return The network used by this stack
+   */
+  const Network &getNetwork() const;
+
+ private:
+  /**
+   * @brief Network used to calculate accumulators (shared so that loading a
+   * new network never frees one that a search is still using)
+   */
+  std::shared_ptr<const Network> _network;
+
+  /**
+   * @brief Storage for MAX_SIZE accumulators.
+   */
+  std::unique_ptr<Accumulator[]> _stack;
+
+  /**
+   * @brief Index of the top accumulator in _stack.
+   */
+  int _top;
+};
+
+/**
+ * @brief A non-owning pointer to an AccumulatorStack that is reset to nullptr when copied.
+ *
+ * Boards hold their AccumulatorStack through one of these, so that copies of
+ * a board (eg. to walk the principal variation) never push or pop
+ * accumulators on the stack of the board they were copied from.
+ */
+class AccumulatorStackPtr {
+ public:
+  AccumulatorStackPtr(AccumulatorStack *stack = nullptr) : _stack(stack) {}
+  AccumulatorStackPtr(const AccumulatorStackPtr &) : _stack(nullptr) {}
+
+  AccumulatorStackPtr &operator=(const AccumulatorStackPtr &) {
+    _stack = nullptr;
+    return *this;
+  }
+
+  void reset(AccumulatorStack *stack = nullptr) { _stack = stack; }
+  AccumulatorStack *get() const { return _stack; }
+  AccumulatorStack *operator->() const { return _stack; }
+  explicit operator bool() const { return _stack != nullptr; }
+
+ private:
+  AccumulatorStack *_stack;
+};
+
+/**
+ * @brief Loads the network in the given file, replacing the current network.
+ *
+ * If the file can't be read or isn't a valid network, the current network is
+ * kept.
+ *
+ * @param path Path of the network file
+ * @return true if the network was loaded, false otherwise
+ */
+bool load(const std::string &);
+
+/**
+ * @brief Reads a network from the given stream (see the Nnue namespace for the format).
+ *
+ * @param stream Stream to read the network from
+ * @return The network read, or nullptr if the stream doesn't contain a valid network
+ */
+std::shared_ptr<const Network> read(std::istream &);
+
+/**
+ * @brief Returns the currently loaded network, or nullptr if none has been loaded.
+ *
+ * @return The currently loaded network
+ */
+std::shared_ptr<const Network> getNetwork();
+
+/**
+ * @brief Returns the NNUE evaluation of the given board in centipawns, from
+ * the perspective of the side to move.
+ *
+ * The board must have an AccumulatorStack attached (see Board::setAccumulators()).
+ *
+ * @param board Board to evaluate
+ * @return Advantage of the side to move in centipawns
+ */
+int evaluate(const Board &);
+};
+
+#endif
@@ -34,6 +34,14 @@ Option::Option(bool value, OnChange onChange) :
     _max(0),
     _onChange(onChange) {}
 
+Option::Option(OnChange onChange) :
+    _value(""),
+    _type("button"),
+    _defaultValue(""),
+    _min(0),
+    _max(0),
+    _onChange(onChange) {}
+
 std::string Option::getValue() const {
   return _value;
 }
@@ -2,6 +2,7 @@
 #define OPTIONMANAGER_H
 
 #include <map>
+#include <string>
 
 /**
  * @brief Type of callback function for when an option is changed
@@ -47,6 +48,17 @@ class Option {
    */
   Option(const char *, OnChange= nullptr); // String
 
+  /**
+   * @brief Constructs a new UCI button option with the specified OnChange
+   * callback
+   *
+   * Buttons have no value, the OnChange callback is called each time the
+   * button is pressed (ie. each time its value is set).
+   *
+   * @param onChange Pointer to function to be called when this button is pressed
+   */
+  Option(OnChange);
+
   /**
    * @brief Gets the current value of this option
    * 
@@ -102,7 +114,7 @@ class Option {
   /**
    * @brief Type of this option
    * 
-   * Currently, this can be one of "check", "spin" or "string"
+   * Currently, this can be one of "check", "spin", "string" or "button"
    */
   std::string _type;
 
@@ -1,9 +1,11 @@
 #include "orderinginfo.h"
+#include <algorithm>
 #include <cstring>
 
 OrderingInfo::OrderingInfo(const TranspTable *tt) {
   _tt = tt;
   _ply = 0;
+  _pvLength = 0;
   std::memset(_history, 0, sizeof(_history));
 }
 
@@ -42,4 +44,22 @@ Move OrderingInfo::getKiller1(int ply) const {
 
 Move OrderingInfo::getKiller2(int ply) const {
   return _killer2[ply];
-}
\ No newline at end of file
+}
+
+void OrderingInfo::setPv(const Board &board, const MoveList &pv) {
+  Board currBoard = board;
+  _pvLength = std::min(static_cast<int>(pv.size()), MAX_PLY);
+
+  for (int ply = 0; ply < _pvLength; ply++) {
+    _pv[ply] = pv[ply];
+    _pvKeys[ply] = currBoard.getZKey().getValue();
+    currBoard.doMove(pv[ply]);
+  }
+}
+
+Move OrderingInfo::getPvMove(int ply, const Board &board) const {
+  if (ply < _pvLength && _pvKeys[ply] == board.getZKey().getValue()) {
+    return _pv[ply];
+  }
+  return Move();
+}
@@ -89,6 +89,29 @@ class OrderingInfo {
    */
   Move getKiller2(int) const;
 
+  /**
+   * @brief Sets the principal variation of the previous search iteration.
+   *
+   * The position reached at each ply of the principal variation is recorded,
+   * so that getPvMove() only returns moves for nodes on the principal variation.
+   *
+   * @param board Root board of the search
+   * @param pv    Principal variation from the root board
+   */
+  void setPv(const Board &, const MoveList &);
+
+  /**
+   * @brief Returns the move of the previous principal variation at the given
+   * ply, if the given board is the position reached by the principal variation
+   * at that ply.
+   *
+   * @param ply   Ply of the given board
+   * @param board Board at the given ply
+   * @return The principal variation move for the board, or a null move if the
+   * board is not on the principal variation
+   */
+  Move getPvMove(int, const Board &) const;
+
  private:
   /**
    * @brief Transposition table for the search
@@ -98,12 +121,12 @@ class OrderingInfo {
   /**
    * @brief Array of first killer moves by ply
    */
-  Move _killer1[50];
+  Move _killer1[MAX_PLY];
 
   /**
    * @brief Array of second killer moves by ply
    */
-  Move _killer2[50];
+  Move _killer2[MAX_PLY];
 
   /**
    * @brief Current ply of search
@@ -114,6 +137,22 @@ class OrderingInfo {
    * @brief Table of beta-cutoff history values indexed by [color][from_square][to_square]
    */
   int _history[2][64][64];
+
+  /**
+   * @brief Principal variation of the previous search iteration (see setPv())
+   */
+  Move _pv[MAX_PLY];
+
+  /**
+   * @brief Array indexed by ply of the Zobrist key of the position reached by
+   * the previous principal variation
+   */
+  U64 _pvKeys[MAX_PLY];
+
+  /**
+   * @brief Length of the previous principal variation
+   */
+  int _pvLength;
 };
 
 #endif
\ No newline at end of file
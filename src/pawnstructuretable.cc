@@ -1,18 +1,26 @@
 #include "pawnstructuretable.h"
 #include "defs.h"
-#include "board.h"
-#include <unordered_map>
+#include "eval.h"
 
-std::unordered_map<U64, PawnStructureTable::PawnStructureEntry> _table;
+PawnStructureTable::PawnStructureTable(int size) : _size(ONE) {
+  while (_size * 2 <= static_cast<U64>(size)) {
+    _size *= 2;
+  }
 
-PawnStructureTable::PawnStructureEntry *PawnStructureTable::get(ZKey key) {
-  return &_table.at(key.getValue());
+  // Value initialization zeroes all entries. A zeroed entry is exactly the
+  // entry for a board with no pawns (whose pawn structure key is also 0), so
+  // empty entries never need to be told apart from real ones.
+  _table.reset(new Entry[_size]());
 }
 
-bool PawnStructureTable::exists(ZKey key) {
-  return _table.find(key.getValue()) != _table.end();
-}
+const PawnStructureTable::Entry &PawnStructureTable::probe(const Board &board) {
+  U64 key = board.getPawnStructureZKey().getValue();
+  Entry &entry = _table[key & (_size - 1)];
+
+  if (entry.key != key) {
+    Eval::evaluatePawnStructure(board, entry);
+    entry.key = key;
+  }
 
-void PawnStructureTable::set(ZKey key, PawnStructureTable::PawnStructureEntry entry) {
-  _table.insert(std::make_pair(key.getValue(), entry));
+  return entry;
 }
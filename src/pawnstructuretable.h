@@ -1,55 +1,94 @@
 #ifndef PAWNSTRUCTURETABLE_H
 #define PAWNSTRUCTURETABLE_H
 
+#include "defs.h"
 #include "board.h"
+#include "score.h"
+#include <memory>
 
 /**
- * @namespace PawnStructureTable
- * @brief Namespace holding things related to the pawn structure table
+ * @brief A fixed size hash table of evaluated pawn structures.
  *
- * This is a hash table to store evaluation scores of pawn structures. As
- * pawn structure doesn't often change in a search, evaluation can be sped
- * up by storing old scores in a table.
- */
-namespace PawnStructureTable {
-/**
- * @brief An entry in the pawn structure table
+ * As pawn structure doesn't often change in a search, evaluation can be sped
+ * up by storing old pawn structure scores in a table. Along with the scores,
+ * each entry caches bitboards derived from the pawn structure (passed pawns,
+ * pawn attack spans and occupied files) so that they only need to be
+ * calculated once per pawn structure.
+ *
+ * The table is direct mapped (each key maps to exactly one entry, and new
+ * entries always replace old ones) and is not thread safe, so each search
+ * thread owns its own PawnStructureTable.
  */
-struct PawnStructureEntry {
+class PawnStructureTable {
+ public:
+  /**
+   * @brief An entry in the pawn structure table.
+   *
+   * All arrays are indexed by [Color].
+   */
+  struct Entry {
+    /**
+     * @brief Full pawn structure ZKey value of this entry
+     */
+    U64 key;
+
+    /**
+     * @brief Packed opening and endgame pawn structure score from white's perspective
+     */
+    Score score;
+
+    /**
+     * @brief Bitboards of passed pawns
+     */
+    U64 passedPawns[2];
+
+    /**
+     * @brief Bitboards of all squares that can ever be attacked by pawns as
+     * they advance
+     */
+    U64 attackSpans[2];
+
+    /**
+     * @brief Masks of files containing pawns (bit n is set if there is a
+     * pawn on file n)
+     */
+    unsigned char files[2];
+  };
 
   /**
-   * @brief Array indexed by [GamePhase] of pawn structure scores for this
-   * entry
+   * @brief Default number of entries in a PawnStructureTable.
    */
-  int scores[2];
-};
+  static const int DEFAULT_SIZE = 8192;
 
-/**
- * @brief Gets a pointer to the pawn structure table entry with the given ZKey, or
- * nullptr if it does not exist
- *
- * @param key ZKey to search pawn structure table for
- * @return A Pointer to the PawnStructureEntry with the given ZKey, or nullptr
- * if it does not exist
- */
-PawnStructureEntry *get(ZKey key);
+  /**
+   * @brief Constructs a new empty PawnStructureTable.
+   *
+   * @param size Maximum number of entries (rounded down to a power of two)
+   */
+  PawnStructureTable(int= DEFAULT_SIZE);
 
-/**
- * @brief Returns true if the pawn structure table contains an entry with the
- * given ZKey, false otherwise
- *
- * @return true if the pawn structure table contains an entry with the given
- * ZKey, false otherwise
- */
-bool exists(ZKey);
+  /**
+   * @brief Returns the entry for the pawn structure of the given board.
+   *
+   * If the pawn structure isn't in the table, it is evaluated with
+   * Eval::evaluatePawnStructure() and stored, replacing any entry with the
+   * same index.
+   *
+   * @param board Board to get the pawn structure entry of
+   * @return The entry for the pawn structure of the given board
+   */
+  const Entry &probe(const Board &);
 
-/**
- * @brief Creates a new entry in the pawn structure table
- *
- * @param key ZKey of new entry
- * @param entry New entry to store in table
- */
-void set(ZKey, PawnStructureEntry);
+ private:
+  /**
+   * @brief Entries in this table.
+   */
+  std::unique_ptr<Entry[]> _table;
+
+  /**
+   * @brief Number of entries in this table (always a power of two).
+   */
+  U64 _size;
 };
 
 #endif
@@ -0,0 +1,133 @@
+#include "perft.h"
+#include "movegen.h"
+#include <algorithm>
+#include <thread>
+
+Perft::Perft(int threads, int hashMb) : _threads(std::max(threads, 1)), _hashSize(0) {
+  if (hashMb > 0) {
+    U64 maxEntries = (static_cast<U64>(hashMb) * 1024 * 1024) / sizeof(Entry);
+    _hashSize = ONE;
+    while (_hashSize * 2 <= maxEntries) {
+      _hashSize *= 2;
+    }
+
+    // Value initialization zeroes all entries, marking them as empty
+    _hash.reset(new Entry[_hashSize]());
+  }
+}
+
+unsigned long long Perft::perft(const Board &board, int depth) {
+  if (depth <= 0) {
+    return 1;
+  }
+
+  unsigned long long nodes = 0;
+  for (auto rootCount : divide(board, depth)) {
+    nodes += rootCount.second;
+  }
+
+  return nodes;
+}
+
+std::vector<Perft::RootCount> Perft::divide(const Board &board, int depth) {
+  MoveList rootMoves;
+  MoveGen::genLegalMoves(board, rootMoves);
+
+  std::vector<RootCount> rootCounts;
+  for (auto move : rootMoves) {
+    rootCounts.push_back(RootCount(move, 1));
+  }
+
+  if (depth <= 1) {
+    return rootCounts;
+  }
+
+  // Each thread repeatedly claims the next root move that hasn't been counted
+  std::atomic<size_t> nextRootMove(0);
+  auto countRootMoves = [&]() {
+    Board threadBoard = board;
+
+    size_t i;
+    while ((i = nextRootMove++) < rootCounts.size()) {
+      Move move = rootCounts[i].first;
+
+      UndoInfo undoInfo = threadBoard.doMove(move);
+      rootCounts[i].second = _perft(threadBoard, depth - 1);
+      threadBoard.undoMove(move, undoInfo);
+    }
+  };
+
+  std::vector<std::thread> helpers;
+  for (int i = 1; i < _threads; i++) {
+    helpers.push_back(std::thread(countRootMoves));
+  }
+  countRootMoves();
+
+  for (auto &helper : helpers) {
+    helper.join();
+  }
+
+  return rootCounts;
+}
+
+unsigned long long Perft::_perft(Board &board, int depth) {
+  if (depth == 0) {
+    return 1;
+  }
+
+  MoveList moves;
+
+  // Bulk count leaf nodes (hashing them would cost more than generating their moves)
+  if (depth == 1) {
+    MoveGen::genLegalMoves(board, moves);
+    return moves.size();
+  }
+
+  // Only generate moves if the hash doesn't already have this node's count
+  unsigned long long nodes;
+  if (_probe(board, depth, nodes)) {
+    return nodes;
+  }
+
+  MoveGen::genLegalMoves(board, moves);
+  nodes = 0;
+  for (auto move : moves) {
+    UndoInfo undoInfo = board.doMove(move);
+    nodes += _perft(board, depth - 1);
+    board.undoMove(move, undoInfo);
+  }
+
+  _store(board, depth, nodes);
+  return nodes;
+}
+
+bool Perft::_probe(const Board &board, int depth, unsigned long long &nodes) const {
+  if (!_hash) {
+    return false;
+  }
+
+  U64 key = board.getZKey().getValue();
+  const Entry &entry = _hash[key & (_hashSize - 1)];
+  unsigned long long data = entry.data.load(std::memory_order_relaxed);
+
+  if ((entry.keyXorData.load(std::memory_order_relaxed) ^ data) == key &&
+      static_cast<int>(data & 0xff) == depth) {
+    nodes = data >> 8;
+    return true;
+  }
+
+  return false;
+}
+
+void Perft::_store(const Board &board, int depth, unsigned long long nodes) {
+  if (!_hash) {
+    return;
+  }
+
+  U64 key = board.getZKey().getValue();
+  Entry &entry = _hash[key & (_hashSize - 1)];
+  unsigned long long data = (nodes << 8) | static_cast<unsigned long long>(depth);
+
+  entry.keyXorData.store(key ^ data, std::memory_order_relaxed);
+  entry.data.store(data, std::memory_order_relaxed);
+}
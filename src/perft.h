@@ -0,0 +1,109 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "board.h"
+#include "move.h"
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Counts the leaf nodes of the legal move tree of a position (perft).
+ *
+ * Perft is used to verify move generation against known node counts. Leaf
+ * nodes at depth 1 are counted in bulk from the size of the generated move
+ * list, without playing the moves.
+ *
+ * Root moves are split between a pool of threads. Each thread claims the
+ * next unsearched root move as soon as it finishes its previous one, so no
+ * thread sits idle while others are stuck on large subtrees.
+ *
+ * If a hash table size is given, node counts of subtrees are cached by
+ * (Zobrist key, depth) in a table shared by all threads, so transpositions
+ * are only counted once. Like the TranspTable, the perft hash is lock-free
+ * and rejects entries torn by concurrent writes.
+ */
+class Perft {
+ public:
+  /**
+   * @brief Node count of a single root move, as returned by divide().
+   */
+  typedef std::pair<Move, unsigned long long> RootCount;
+
+  /**
+   * @brief Constructs a new Perft.
+   *
+   * @param threads Number of threads to count nodes with
+   * @param hashMb Size of the perft hash table in megabytes (0 to disable)
+   */
+  Perft(int= 1, int= 0);
+
+  /**
+   * @brief Returns the number of leaf nodes at the given depth from the given board.
+   *
+   * @param board Board to count nodes from
+   * @param depth Depth to count nodes to
+   * @return The number of leaf nodes at the given depth
+   */
+  unsigned long long perft(const Board &, int);
+
+  /**
+   * @brief Returns the number of leaf nodes at the given depth below each
+   * legal move of the given board.
+   *
+   * Node counts are returned in the order that the moves are generated.
+   *
+   * @param board Board to count nodes from
+   * @param depth Depth to count nodes to (including the root moves)
+   * @return A vector containing each legal move and its node count
+   */
+  std::vector<RootCount> divide(const Board &, int);
+
+ private:
+  /**
+   * @brief A single perft hash table entry.
+   *
+   * The data word stores the node count in its upper 56 bits and the depth in
+   * its lower 8 bits.
+   */
+  struct Entry {
+    std::atomic<unsigned long long> keyXorData;
+    std::atomic<unsigned long long> data;
+  };
+
+  /**
+   * @brief Number of threads to count nodes with.
+   */
+  int _threads;
+
+  /**
+   * @brief Perft hash table (nullptr if disabled).
+   */
+  std::unique_ptr<Entry[]> _hash;
+
+  /**
+   * @brief Number of entries in the perft hash table (always a power of two).
+   */
+  U64 _hashSize;
+
+  /**
+   * @brief Recursively counts the leaf nodes at the given depth from the given board.
+   *
+   * @param board Board to count nodes from (restored before returning)
+   * @param depth Depth to count nodes to
+   * @return The number of leaf nodes at the given depth
+   */
+  unsigned long long _perft(Board &, int);
+
+  /**
+   * @name Perft hash table functions
+   *
+   * @{
+   */
+  bool _probe(const Board &, int, unsigned long long &) const;
+  void _store(const Board &, int, unsigned long long);
+  /**@}*/
+};
+
+#endif
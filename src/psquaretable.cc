@@ -1,23 +1,21 @@
 #include "psquaretable.h"
 #include "board.h"
-#include <algorithm>
 
-int PSquareTable::PIECE_VALUES[2][2][6][64];
+constexpr void PSquareTable::_setValues(PieceValues &values, const int (&list)[64], PieceType pieceType,
+                                        GamePhase phase) {
+  for (int square = 0; square < 64; square++) {
+    values[BLACK][pieceType][square] += phase == OPENING ? makeScore(list[square], 0) : makeScore(0, list[square]);
 
-std::vector<int> PSquareTable::_mirrorList(std::vector<int> list) {
-  std::reverse(list.begin(), list.end());
-  return list;
+    // Values for white are mirrored along the x axis
+    values[WHITE][pieceType][square] +=
+        phase == OPENING ? makeScore(list[63 - square], 0) : makeScore(0, list[63 - square]);
+  }
 }
 
-void PSquareTable::_setValues(std::vector<int> list, PieceType pieceType, GamePhase phase) {
-  std::copy(list.begin(), list.end(), PIECE_VALUES[phase][BLACK][pieceType]);
-
-  std::vector<int> mirrored = _mirrorList(list);
-  std::copy(mirrored.begin(), mirrored.end(), PIECE_VALUES[phase][WHITE][pieceType]);
-}
+constexpr PSquareTable::PieceValues PSquareTable::_makePieceValues() {
+  PieceValues values{};
 
-void PSquareTable::init() {
-  _setValues(std::vector<int>({
+  _setValues(values, {
     0,  0,  0,  0,  0,  0,  0,  0,
     50, 50, 50, 50, 50, 50, 50, 50,
     10, 10, 20, 30, 30, 20, 10, 10,
@@ -26,9 +24,9 @@ void PSquareTable::init() {
     5, -5,-10,  0,  0,-10, -5,  5,
     5, 10, 10,-20,-20, 10, 10,  5,
     0,  0,  0,  0,  0,  0,  0,  0
-  }), PAWN, OPENING);
+  }, PAWN, OPENING);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     -50,-40,-30,-30,-30,-30,-40,-50,
     -40,-20,  0,  0,  0,  0,-20,-40,
     -30,  0, 10, 15, 15, 10,  0,-30,
@@ -37,9 +35,9 @@ void PSquareTable::init() {
     -30,  5, 10, 15, 15, 10,  5,-30,
     -40,-20,  0,  5,  5,  0,-20,-40,
     -50,-40,-30,-30,-30,-30,-40,-50
-  }), KNIGHT, OPENING);
+  }, KNIGHT, OPENING);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     -20,-10,-10,-10,-10,-10,-10,-20,
     -10,  0,  0,  0,  0,  0,  0,-10,
     -10,  0,  5, 10, 10,  5,  0,-10,
@@ -48,9 +46,9 @@ void PSquareTable::init() {
     -10, 10, 10, 10, 10, 10, 10,-10,
     -10,  5,  0,  0,  0,  0,  5,-10,
     -20,-10,-10,-10,-10,-10,-10,-20
-  }), BISHOP, OPENING);
+  }, BISHOP, OPENING);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     0,  0,  0,  0,  0,  0,  0,  0,
     5,  0,  0,  0,  0,  0,  0,  5,
    -5,  0,  0,  0,  0,  0,  0, -5,
@@ -59,9 +57,9 @@ void PSquareTable::init() {
    -5,  0,  0,  0,  0,  0,  0, -5,
    -5,  0,  0,  0,  0,  0,  0, -5,
     0,  0,  0,  5,  5,  0,  0,  0
-  }), ROOK, OPENING);
+  }, ROOK, OPENING);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     -20,-10,-10, -5, -5,-10,-10,-20,
     -10,  0,  0,  0,  0,  0,  0,-10,
     -10,  0,  5,  5,  5,  5,  0,-10,
@@ -70,9 +68,9 @@ void PSquareTable::init() {
     -10,  5,  5,  5,  5,  5,  0,-10,
     -10,  0,  5,  0,  0,  0,  0,-10,
     -20,-10,-10, -5, -5,-10,-10,-20
-  }), QUEEN, OPENING);
+  }, QUEEN, OPENING);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     -30,-40,-40,-50,-50,-40,-40,-30,
     -30,-40,-40,-50,-50,-40,-40,-30,
     -30,-40,-40,-50,-50,-40,-40,-30,
@@ -81,10 +79,10 @@ void PSquareTable::init() {
     -10,-20,-20,-20,-20,-20,-20,-10,
      20, 20,  0,  0,  0,  0, 20, 20,
      30, 30, 20,  20, 20, 30, 30, 30
-  }), KING, OPENING);
+  }, KING, OPENING);
 
   // ENDGAME
-  _setValues(std::vector<int>({
+  _setValues(values, {
      0,   0,  0,  0,  0,  0,  0,  0,
      80, 80, 80, 80, 80, 80, 80, 80,
      60, 60, 60, 60, 60, 60, 60, 60,
@@ -93,9 +91,9 @@ void PSquareTable::init() {
       0,  0,  0,  0,  0,  0,  0,  0,
     -20,-20,-20,-20,-20,-20,-20,-20,
     0,  0,  0,  0,  0,  0,  0,  0
-  }), PAWN, ENDGAME);
+  }, PAWN, ENDGAME);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     -50,-40,-30,-30,-30,-30,-40,-50,
     -40,-20,  0,  0,  0,  0,-20,-40,
     -30,  0, 10, 15, 15, 10,  0,-30,
@@ -104,9 +102,9 @@ void PSquareTable::init() {
     -30,  5, 10, 15, 15, 10,  5,-30,
     -40,-20,  0,  5,  5,  0,-20,-40,
     -50,-40,-30,-30,-30,-30,-40,-50
-  }), KNIGHT, ENDGAME);
+  }, KNIGHT, ENDGAME);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     -20,-10,-10,-10,-10,-10,-10,-20,
     -10,  0,  0,  0,  0,  0,  0,-10,
     -10,  0,  5, 10, 10,  5,  0,-10,
@@ -115,9 +113,9 @@ void PSquareTable::init() {
     -10, 10, 10, 10, 10, 10, 10,-10,
     -10,  5,  0,  0,  0,  0,  5,-10,
     -20,-10,-10,-10,-10,-10,-10,-20
-  }), BISHOP, ENDGAME);
+  }, BISHOP, ENDGAME);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     0,  0,  0,  0,  0,  0,  0,  0,
    -5,  0,  0,  0,  0,  0,  0, -5,
    -5,  0,  0,  0,  0,  0,  0, -5,
@@ -126,9 +124,9 @@ void PSquareTable::init() {
    -5,  0,  0,  0,  0,  0,  0, -5,
    -5,  0,  0,  0,  0,  0,  0, -5,
     0,  0,  0,  0,  0,  0,  0,  0
-  }), ROOK, ENDGAME);
+  }, ROOK, ENDGAME);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     -20,-10,-10, -5, -5,-10,-10,-20,
     -10,  0,  0,  0,  0,  0,  0,-10,
     -10,  0,  5,  5,  5,  5,  0,-10,
@@ -137,9 +135,9 @@ void PSquareTable::init() {
     -10,  5,  5,  5,  5,  5,  0,-10,
     -10,  0,  5,  0,  0,  0,  0,-10,
     -20,-10,-10, -5, -5,-10,-10,-20
-  }), QUEEN, ENDGAME);
+  }, QUEEN, ENDGAME);
 
-  _setValues(std::vector<int>({
+  _setValues(values, {
     -50,-40,-30,-20,-20,-30,-40,-50,
     -30,-20,-10,  0,  0,-10,-20,-30,
     -30,-10, 20, 30, 30, 20,-10,-30,
@@ -148,9 +146,13 @@ void PSquareTable::init() {
     -30,-10, 20, 30, 30, 20,-10,-30,
     -30,-30,  0,  0,  0,  0,-30,-30,
     -50,-30,-30,-30,-30,-30,-30,-50
-  }), KING, ENDGAME);
+  }, KING, ENDGAME);
+
+  return values;
 }
 
+constexpr PSquareTable::PieceValues PSquareTable::PIECE_VALUES = PSquareTable::_makePieceValues();
+
 PSquareTable::PSquareTable() = default;
 
 PSquareTable::PSquareTable(const Board &board) {
@@ -170,13 +172,11 @@ PSquareTable::PSquareTable(const Board &board) {
 }
 
 void PSquareTable::addPiece(Color color, PieceType pieceType, unsigned int square) {
-  _scores[OPENING][color] += PIECE_VALUES[OPENING][color][pieceType][square];
-  _scores[ENDGAME][color] += PIECE_VALUES[ENDGAME][color][pieceType][square];
+  _scores[color] += PIECE_VALUES[color][pieceType][square];
 }
 
 void PSquareTable::removePiece(Color color, PieceType pieceType, unsigned int square) {
-  _scores[OPENING][color] -= PIECE_VALUES[OPENING][color][pieceType][square];
-  _scores[ENDGAME][color] -= PIECE_VALUES[ENDGAME][color][pieceType][square];
+  _scores[color] -= PIECE_VALUES[color][pieceType][square];
 }
 
 void PSquareTable::movePiece(Color color, PieceType pieceType, unsigned int fromSquare, unsigned int toSquare) {
@@ -184,6 +184,10 @@ void PSquareTable::movePiece(Color color, PieceType pieceType, unsigned int from
   addPiece(color, pieceType, toSquare);
 }
 
-int PSquareTable::getScore(GamePhase phase, Color color) {
-  return _scores[phase][color];
+Score PSquareTable::getScore(Color color) const {
+  return _scores[color];
+}
+
+int PSquareTable::getScore(GamePhase phase, Color color) const {
+  return phase == OPENING ? getOpeningScore(_scores[color]) : getEndgameScore(_scores[color]);
 }
@@ -2,12 +2,16 @@
 #define PSQUARETABLE_H
 
 #include "defs.h"
-#include <vector>
+#include "table.h"
+#include "score.h"
 
 class Board;
 
 /**
  * @brief Represents a Piece Square Table.
+ *
+ * Opening and endgame square values are stored together as packed Scores,
+ * so adding, removing or moving a piece updates both phases at once.
  */
 class PSquareTable {
  public:
@@ -20,13 +24,6 @@ class PSquareTable {
    */
   PSquareTable(const Board&);
 
-  /**
-   * @brief Initializes PSquareTable square values.
-   *
-   * This must be called once prior to using a PSquareTable.
-   */
-  static void init();
-
   /**
    * @brief Adds a piece at the given square.
    *
@@ -55,6 +52,15 @@ class PSquareTable {
    */
   void movePiece(Color, PieceType, unsigned int, unsigned int);
 
+  /**
+   * @brief Gets the piece square table score of the given player for both
+   * game phases
+   *
+   * @param color Color to get score for
+   * @return The packed opening and endgame piece square table score for the given player
+   */
+  Score getScore(Color) const;
+
   /**
    * @brief Gets the piece square table score of the given player in the
    * given phase
@@ -63,39 +69,45 @@ class PSquareTable {
    * @param  color Color to get score for
    * @return The piece square table score for the given player
    */
-  int getScore(GamePhase, Color);
+  int getScore(GamePhase, Color) const;
 
  private:
   /**
-   * @brief Array indexed by [GamePhase][Color][PieceType][SquareIndex] of square values for each  piece,
-   * square and color.
+   * @brief Table indexed by [Color][PieceType][SquareIndex] of packed square values
    */
-  static int PIECE_VALUES[2][2][6][64];
+  typedef Table<Table<Table<Score, 64>, 6>, 2> PieceValues;
 
   /**
-   * @brief Sets PIECE_VALUES for white and black for the given game phase
+   * @brief Table indexed by [Color][PieceType][SquareIndex] of packed opening and endgame
+   * square values for each piece, square and color.
+   */
+  static const PieceValues PIECE_VALUES;
+
+  /**
+   * @brief Builds PIECE_VALUES at compile time.
+   *
+   * @return Square values for each piece, square and color
+   */
+  static constexpr PieceValues _makePieceValues();
+
+  /**
+   * @brief Sets the part of PIECE_VALUES for the given game phase for white and black
    *
    * Note that this function must be given the values for black and will set
-   * the entry in PIECE_VALUES for white and black.
+   * the entry in PIECE_VALUES for white and black. The values of the other
+   * game phase are left unchanged.
    *
+   * @param values Table to set values in
    * @param list Square values for black.
    * @param pieceType Piece type to set values for.
    * @param phase GamePhase to set values for
    */
-  static void _setValues(std::vector<int>, PieceType, GamePhase);
-
-  /**
-   * @brief Mirrors the list of square values along the x axis.
-   *
-   * @param  list Square values to mirror
-   * @return Mirrored square values
-   */
-  static std::vector<int> _mirrorList(std::vector<int>);
+  static constexpr void _setValues(PieceValues &, const int (&)[64], PieceType, GamePhase);
 
   /**
-   * @brief Array indexed by [GamePhase][Color] of each color's piece square table score.
+   * @brief Array indexed by [Color] of each color's packed piece square table score.
    */
-  int _scores[2][2] = {{0}};
+  Score _scores[2] = {0};
 };
 
 #endif
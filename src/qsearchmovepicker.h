@@ -7,9 +7,12 @@
  * @brief MovePicker that returns moves in an optimal order for quiescense 
  * search
  * 
- * Specifically, the QSearchMovePicker returns only capture moves in MVV/LVA
- * order, followed by promotions by value of promotion piece, ignoring all
+ * Specifically, the QSearchMovePicker returns capture moves in MVV/LVA
+ * order, followed by promotions by value of promotion piece, followed by all
  * other moves.
+ *
+ * Quiescence search only provides captures and promotions (see
+ * MoveGen::CAPTURES), or check evasions if in check (see MoveGen::EVASIONS).
  */
 class QSearchMovePicker : MovePicker {
  public:
@@ -20,12 +23,12 @@ class QSearchMovePicker : MovePicker {
    */
   QSearchMovePicker(MoveList *);
 
-  bool hasNext() const override;
+  bool hasNext() override;
 
   /**
   * @brief Returns the next best move in this QSearchMovePicker's MoveList for quiescense search.
   *
-  * Note that internally, this method performs a selection sort for one unpicked capture move of the
+  * Note that internally, this method performs a selection sort for one unpicked move of the
   * highest value in this QSearchMovePicker's internal MoveList and thus has time complexity
   * O(n) with respect to the size of the MoveList. Provided move ordering is close to optimal though,
   * this should be the optimal behaviour as quiescense search should hit a beta cutoff after a small
@@ -37,7 +40,7 @@ class QSearchMovePicker : MovePicker {
 
  private:
   /**
-   * @brief Assigns a value to each capture move in this QSearchMovePicker representing desirability
+   * @brief Assigns a value to each move in this QSearchMovePicker representing desirability
    * according to MVV/LVA.
    */
   void _scoreMoves();
@@ -46,11 +49,6 @@ class QSearchMovePicker : MovePicker {
    * @brief Head of the current sorted part of the MoveList
    */
   size_t _currHead;
-
-  /**
-   * @brief Number of captures in this QSearchMovePicker's MoveList
-   */
-  size_t _numCaptures;
 };
 
 #endif
\ No newline at end of file
@@ -1,36 +1,47 @@
 #include "rays.h"
-#include "bitutils.h"
 
-U64 Rays::detail::_rays[8][64];
-
-void Rays::init() {
-  for (int square = 0; square < 64; square++) {
-    // North
-    detail::_rays[NORTH][square] = 0x0101010101010100ULL << square;
-
-    // South
-    detail::_rays[SOUTH][square] = 0x0080808080808080ULL >> (63 - square);
-
-    // East
-    detail::_rays[EAST][square] = 2 * ((ONE << (square | 7)) - (ONE << square));
-
-    // West
-    detail::_rays[WEST][square] = (ONE << square) - (ONE << (square & 56));
+namespace {
+/**
+ * @brief Calculates the squares between (if between is true) or the line
+ * through (if between is false) every pair of aligned squares.
+ */
+constexpr Rays::detail::SquarePairTable makeSquarePairTable(bool between) {
+  using namespace Rays;
+
+  detail::RayTable rays = detail::_makeRays();
+  detail::SquarePairTable table{};
+
+  // Opposite of each direction, indexed by Dir
+  const Dir opposite[8] = {SOUTH, NORTH, WEST, EAST, SOUTH_WEST, SOUTH_EAST, NORTH_WEST, NORTH_EAST};
+
+  for (int from = 0; from < 64; from++) {
+    for (int dir = NORTH; dir <= SOUTH_WEST; dir++) {
+      U64 line = rays[dir][from] | rays[opposite[dir]][from] | (ONE << from);
+
+      U64 ray = rays[dir][from];
+      while (ray) {
+        int to = _popLsb(ray);
+        table[from][to] = between ? rays[dir][from] & ~rays[dir][to] & ~(ONE << to) : line;
+      }
+    }
+  }
 
-    // North West
-    detail::_rays[NORTH_WEST][square] = _westN(0x102040810204000ULL, 7 - _col(square)) << (_row(square) * 8);
+  return table;
+}
+}
 
-    // North East
-    detail::_rays[NORTH_EAST][square] = _eastN(0x8040201008040200ULL, _col(square)) << (_row(square) * 8);
+constexpr Rays::detail::RayTable Rays::detail::_rays = Rays::detail::_makeRays();
+constexpr Rays::detail::SquarePairTable Rays::detail::_between = makeSquarePairTable(true);
+constexpr Rays::detail::SquarePairTable Rays::detail::_lines = makeSquarePairTable(false);
 
-    // South West
-    detail::_rays[SOUTH_WEST][square] = _westN(0x40201008040201ULL, 7 - _col(square)) >> ((7 - _row(square)) * 8);
+U64 Rays::getRay(Dir dir, int square) {
+  return detail::_rays[dir][square];
+}
 
-    // South East
-    detail::_rays[SOUTH_EAST][square] = _eastN(0x2040810204080ULL, _col(square)) >> ((7 - _row(square)) * 8);
-  }
+U64 Rays::getBetween(int from, int to) {
+  return detail::_between[from][to];
 }
 
-U64 Rays::getRay(Dir dir, int square) {
-  return detail::_rays[dir][square];
+U64 Rays::getLine(int from, int to) {
+  return detail::_lines[from][to];
 }
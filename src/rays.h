@@ -2,25 +2,23 @@
 #define RAYS_H
 
 #include "defs.h"
+#include "bitutils.h"
+#include "table.h"
 
 /**
  * @brief Namespace containg fast ray generation functions
  *
- * This namespace contains an init() function, which initializes a table of
- * 8*64 ray bitboards for each square and cardinal/intercardinal direction.
+ * This namespace contains a table of 8*64 ray bitboards for each square and
+ * cardinal/intercardinal direction, which is calculated at compile time.
  *
  * In time intensive scenarios Rays::getRay() can then be used to get ray
  * bitboards when needed (eg. as masks for evaluation purposes).
+ *
+ * Tables of the squares between and the lines through any two squares are
+ * also built from the ray table (eg. for finding pinned pieces and blocking
+ * squares during move generation).
  */
 namespace Rays {
-namespace detail {
-
-/**
- * @brief Internal table of precalculated ray bitboards indexed by [Dir][square]
- */
-extern U64 _rays[8][64];
-};
-
 /**
  * @enum Dir
  * @brief Enum representing the eight cardinal and intercardinal directions
@@ -36,10 +34,74 @@ enum Dir {
   SOUTH_WEST
 };
 
+namespace detail {
+/**
+ * @brief Table of ray bitboards indexed by [Dir][square]
+ */
+typedef Table<Table<U64, 64>, 8> RayTable;
+
 /**
- * @brief Initializes the internal table of ray bitboards
+ * @brief Table of bitboards indexed by [square][square]
  */
-void init();
+typedef Table<Table<U64, 64>, 64> SquarePairTable;
+
+/**
+ * @brief Calculates the ray bitboards for every direction and square.
+ *
+ * This is defined here so that other tables calculated at compile time can
+ * be built from rays.
+ *
+ * @return A table of ray bitboards indexed by [Dir][square]
+ */
+constexpr RayTable _makeRays() {
+  RayTable rays{};
+
+  for (int square = 0; square < 64; square++) {
+    // North
+    rays[NORTH][square] = 0x0101010101010100ULL << square;
+
+    // South
+    rays[SOUTH][square] = 0x0080808080808080ULL >> (63 - square);
+
+    // East
+    rays[EAST][square] = 2 * ((ONE << (square | 7)) - (ONE << square));
+
+    // West
+    rays[WEST][square] = (ONE << square) - (ONE << (square & 56));
+
+    // North West
+    rays[NORTH_WEST][square] = _westN(0x102040810204000ULL, 7 - _col(square)) << (_row(square) * 8);
+
+    // North East
+    rays[NORTH_EAST][square] = _eastN(0x8040201008040200ULL, _col(square)) << (_row(square) * 8);
+
+    // South West
+    rays[SOUTH_WEST][square] = _westN(0x40201008040201ULL, 7 - _col(square)) >> ((7 - _row(square)) * 8);
+
+    // South East
+    rays[SOUTH_EAST][square] = _eastN(0x2040810204080ULL, _col(square)) >> ((7 - _row(square)) * 8);
+  }
+
+  return rays;
+}
+
+/**
+ * @brief Internal table of precalculated ray bitboards indexed by [Dir][square]
+ */
+extern const RayTable _rays;
+
+/**
+ * @brief Internal table of bitboards containing the squares strictly between
+ * two aligned squares, indexed by [square][square]
+ */
+extern const SquarePairTable _between;
+
+/**
+ * @brief Internal table of bitboards containing the full line through two
+ * aligned squares, indexed by [square][square]
+ */
+extern const SquarePairTable _lines;
+};
 
 /**
  * @brief Gets a bitboard containing the given ray in the given direction.
@@ -49,6 +111,28 @@ void init();
  * @return A bitboard containing the given ray in the given direction
  */
 U64 getRay(Dir, int);
+
+/**
+ * @brief Gets a bitboard containing the squares strictly between the two given
+ * squares.
+ *
+ * @param from First square (in little endian rank file mapping form)
+ * @param to Second square (in little endian rank file mapping form)
+ * @return A bitboard containing the squares between from and to, or an empty
+ * bitboard if they do not share a rank, file or diagonal
+ */
+U64 getBetween(int, int);
+
+/**
+ * @brief Gets a bitboard containing the entire rank, file or diagonal passing
+ * through the two given squares.
+ *
+ * @param from First square (in little endian rank file mapping form)
+ * @param to Second square (in little endian rank file mapping form)
+ * @return A bitboard containing the line through from and to (edge to edge), or an
+ * empty bitboard if they do not share a rank, file or diagonal
+ */
+U64 getLine(int, int);
 };
 
 #endif
@@ -0,0 +1,64 @@
+/**
+ * @file
+ *
+ * Contains the packed Score type used by the evaluation and functions to
+ * create and unpack Scores.
+ */
+
+#ifndef SCORE_H
+#define SCORE_H
+
+#include "defs.h"
+#include <cstdint>
+
+/**
+ * @brief A pair of opening and endgame scores (in centipawns) packed into a
+ * single integer.
+ *
+ * The opening score is stored in the lower 16 bits and the endgame score in
+ * the upper 16 bits. Scores can be added, subtracted, negated and multiplied
+ * by an integer as normal integers, which applies the operation to both
+ * halves at once, so each evaluation term only needs to be computed once for
+ * both game phases. Both halves must stay within the range of a 16 bit
+ * signed integer.
+ *
+ * Scores must be created with makeScore() and unpacked with
+ * getOpeningScore() and getEndgameScore().
+ */
+typedef int32_t Score;
+
+/**
+ * @brief Returns a Score made up of the given opening and endgame scores.
+ *
+ * @param opening Opening score
+ * @param endgame Endgame score
+ * @return A Score made up of the given opening and endgame scores
+ */
+constexpr Score makeScore(int opening, int endgame) {
+  return static_cast<Score>(static_cast<uint32_t>(endgame) << 16) + opening;
+}
+
+/**
+ * @brief Returns the opening part of the given Score.
+ *
+ * @param score Score to unpack
+ * @return The opening part of the given Score
+ */
+inline int getOpeningScore(Score score) {
+  return static_cast<int16_t>(static_cast<uint16_t>(static_cast<uint32_t>(score)));
+}
+
+/**
+ * @brief Returns the endgame part of the given Score.
+ *
+ * A negative opening score borrows one from the upper 16 bits, which is added
+ * back by rounding before the shift.
+ *
+ * @param score Score to unpack
+ * @return The endgame part of the given Score
+ */
+inline int getEndgameScore(Score score) {
+  return static_cast<int16_t>(static_cast<uint16_t>((static_cast<uint32_t>(score) + 0x8000) >> 16));
+}
+
+#endif
@@ -5,17 +5,27 @@
 #include "generalmovepicker.h"
 #include "qsearchmovepicker.h"
 #include <algorithm>
+#include <cmath>
 #include <iostream>
-
-Search::Search(const Board &board, Limits limits, std::vector<ZKey> positionHistory, bool logUci) :
+#include <thread>
+
+Search::Search(const Board &board,
+               Limits limits,
+               std::vector<ZKey> positionHistory,
+               TranspTable *tt,
+               bool logUci,
+               int threads) :
     _positionHistory(positionHistory),
-    _orderingInfo(OrderingInfo(&_tt)),
+    _orderingInfo(OrderingInfo(tt)),
     _limits(limits),
     _initialBoard(board),
     _logUci(logUci),
     _stop(false),
     _limitCheckCount(0),
-    _bestScore(0) {
+    _nodes(0),
+    _tt(tt),
+    _bestScore(0),
+    _threadId(0) {
 
   if (_limits.infinite) { // Infinite search
     _searchDepth = INF;
@@ -55,46 +65,215 @@ Search::Search(const Board &board, Limits limits, std::vector<ZKey> positionHist
     _searchDepth = DEFAULT_SEARCH_DEPTH;
     _timeAllocated = INF;
   }
+
+  _acquireEvalCache();
+
+  // Each thread updates its own accumulators as it searches its own copy of the board
+  std::shared_ptr<const Nnue::Network> network = Nnue::getNetwork();
+  if (_useNnue && network) {
+    _accumulators.reset(new Nnue::AccumulatorStack(network));
+    _initialBoard.setAccumulators(_accumulators.get());
+  }
+
+  // Helpers share the transposition table and only stop when told to by this search
+  for (int threadId = 1; threadId < threads; threadId++) {
+    std::unique_ptr<Search> helper(new Search(board, limits, positionHistory, tt, false));
+    helper->_threadId = threadId;
+    _helpers.push_back(std::move(helper));
+  }
+}
+
+Search::~Search() {
+  _releaseEvalCache();
 }
 
 void Search::iterDeep() {
   _start = std::chrono::steady_clock::now();
+  _tt->newSearch();
+
+  std::vector<std::thread> helperThreads;
+  for (auto &helper : _helpers) {
+    helperThreads.push_back(std::thread(&Search::_helperIterDeep, helper.get()));
+  }
 
   for (int currDepth = 1; currDepth <= _searchDepth; currDepth++) {
-    _rootMax(_initialBoard, currDepth);
+    _aspirationSearch(currDepth);
 
-    int elapsed =
-        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start).count();
+    int elapsed = _getElapsed();
 
     // If limits were exceeded in the search, break without logging UCI info (search was incomplete)
     if (_stop) break;
 
     if (_logUci) {
-      _logUciInfo(_getPv(currDepth), currDepth, _bestScore, _nodes, elapsed);
+      _logUciInfo(_pv, currDepth, _bestScore, TranspTableEntry::EXACT, getNodes(), elapsed);
     }
 
     // If the last search has exceeded or hit 50% of the allocated time, stop searching
     if (elapsed >= (_timeAllocated / 2)) break;
   }
 
-  if (_logUci) std::cout << "bestmove " << getBestMove().getNotation() << std::endl;
+  for (auto &helper : _helpers) {
+    helper->stop();
+  }
+  for (auto &helperThread : helperThreads) {
+    helperThread.join();
+  }
+
+  if (_logUci) {
+    std::cout << "info string eval cache hit rate " << static_cast<int>(getEvalCacheHitRate() * 100) << "%" << std::endl;
+    std::cout << "bestmove " << getBestMove().getNotation() << std::endl;
+  }
+}
+
+void Search::_helperIterDeep() {
+  _start = std::chrono::steady_clock::now();
+
+  // Odd numbered helpers search one ply deeper than the main thread on each
+  // iteration so that threads don't all search the same tree in lockstep
+  for (int currDepth = 1 + (_threadId % 2); currDepth <= _searchDepth && !_stop; currDepth++) {
+    _aspirationSearch(currDepth);
+  }
+}
+
+void Search::_aspirationSearch(int depth) {
+  // Shallow searches are cheap and their scores unstable, and mate scores
+  // can't be used to center a window, so use a full window for these
+  if (depth < ASPIRATION_MIN_DEPTH || _bestScore == INF || _bestScore == -INF) {
+    _rootMax(_initialBoard, depth, -INF, INF);
+    return;
+  }
+
+  int delta = ASPIRATION_WINDOW;
+  int alpha = _bestScore - delta;
+  int beta = _bestScore + delta;
+
+  while (true) {
+    int score = _rootMax(_initialBoard, depth, alpha, beta);
+    if (_stop) {
+      return;
+    }
+
+    TranspTableEntry::Flag bound;
+    if (score <= alpha && alpha != -INF) {
+      bound = TranspTableEntry::UPPER_BOUND;
+    } else if (score >= beta && beta != INF) {
+      bound = TranspTableEntry::LOWER_BOUND;
+    } else {
+      return;
+    }
+
+    if (_logUci) {
+      _logUciInfo(_pv, depth, score, bound, getNodes(), _getElapsed());
+    }
+
+    // Widen the window on the side that failed, opening it completely once it
+    // gets too wide or a mate score was returned
+    delta *= 2;
+    bool fullWindow = delta > ASPIRATION_MAX_WINDOW || score == INF || score == -INF;
+    if (bound == TranspTableEntry::UPPER_BOUND) {
+      alpha = fullWindow ? -INF : score - delta;
+    } else {
+      beta = fullWindow ? INF : score + delta;
+    }
+  }
 }
 
-MoveList Search::_getPv(int length) {
-  MoveList pv;
-  Board currBoard = _initialBoard;
-  const TranspTableEntry *currEntry;
-  int currLength = 0;
+int Search::_getElapsed() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start).count();
+}
 
-  while (currLength++ < length && (currEntry = _tt.getEntry(currBoard.getZKey()))) {
-    pv.push_back(currEntry->getBestMove());
-    currBoard.doMove(currEntry->getBestMove());
+unsigned long long Search::getNodes() const {
+  unsigned long long nodes = _nodes;
+  for (auto &helper : _helpers) {
+    nodes += helper->_nodes;
   }
+  return nodes;
+}
 
-  return pv;
+double Search::getEvalCacheHitRate() const {
+  unsigned long long probes = _evalCache->getProbes();
+  unsigned long long hits = _evalCache->getHits();
+  for (auto &helper : _helpers) {
+    probes += helper->_evalCache->getProbes();
+    hits += helper->_evalCache->getHits();
+  }
+  return probes == 0 ? 0.0 : static_cast<double>(hits) / probes;
 }
 
-void Search::_logUciInfo(const MoveList &pv, int depth, int bestScore, int nodes, int elapsed) {
+int Search::_evalCacheSizeMb = EvalCache::DEFAULT_SIZE_MB;
+
+Search::EvalCachePool &Search::_getEvalCachePool() {
+  static EvalCachePool *pool = new EvalCachePool();
+  return *pool;
+}
+
+void Search::setEvalCacheSize(int sizeMb) {
+  EvalCachePool &pool = _getEvalCachePool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+
+  _evalCacheSizeMb = sizeMb;
+  pool.idle.clear();
+  pool.generation++;
+}
+
+void Search::clearEvalCaches() {
+  EvalCachePool &pool = _getEvalCachePool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+
+  for (auto &evalCache : pool.idle) {
+    evalCache->clear();
+  }
+  pool.generation++;
+}
+
+void Search::_acquireEvalCache() {
+  EvalCachePool &pool = _getEvalCachePool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+
+  if (pool.idle.empty()) {
+    _evalCache.reset(new EvalCache(_evalCacheSizeMb));
+  } else {
+    _evalCache = std::move(pool.idle.back());
+    pool.idle.pop_back();
+    _evalCache->resetStats();
+  }
+  _evalCacheGeneration = pool.generation;
+}
+
+void Search::_releaseEvalCache() {
+  EvalCachePool &pool = _getEvalCachePool();
+  std::lock_guard<std::mutex> lock(pool.mutex);
+
+  // Caches of the wrong size or holding stale evaluations are freed
+  if (_evalCacheGeneration == pool.generation) {
+    pool.idle.push_back(std::move(_evalCache));
+  }
+}
+
+bool Search::_useNnue = false;
+
+void Search::setUseNnue(bool useNnue) {
+  if (useNnue != _useNnue) {
+    clearEvalCaches();
+  }
+  _useNnue = useNnue;
+}
+
+void Search::_updatePv(int ply, Move move) {
+  _pvTable[ply][0] = move;
+
+  // Append the principal variation of the child node
+  int childLength = ply + 1 < MAX_PLY ? _pvLength[ply + 1] : 0;
+  std::copy(_pvTable[ply + 1], _pvTable[ply + 1] + childLength, _pvTable[ply] + 1);
+  _pvLength[ply] = childLength + 1;
+}
+
+void Search::_logUciInfo(const MoveList &pv,
+                         int depth,
+                         int bestScore,
+                         TranspTableEntry::Flag bound,
+                         unsigned long long nodes,
+                         int elapsed) {
   std::string pvString;
   for (auto move : pv) {
     pvString += move.getNotation() + " ";
@@ -103,12 +282,18 @@ void Search::_logUciInfo(const MoveList &pv, int depth, int bestScore, int nodes
   std::string scoreString;
   if (bestScore == INF) {
     scoreString = "mate " + std::to_string(pv.size());
-  } else if (_bestScore == -INF) {
+  } else if (bestScore == -INF) {
     scoreString = "mate -" + std::to_string(pv.size());
   } else {
     scoreString = "cp " + std::to_string(bestScore);
   }
 
+  if (bound == TranspTableEntry::LOWER_BOUND) {
+    scoreString += " lowerbound";
+  } else if (bound == TranspTableEntry::UPPER_BOUND) {
+    scoreString += " upperbound";
+  }
+
   // Avoid divide by zero errors with nps
   elapsed++;
 
@@ -129,59 +314,66 @@ Move Search::getBestMove() {
   return _bestMove;
 }
 
+const MoveList &Search::getPv() const {
+  return _pv;
+}
+
 bool Search::_checkLimits() {
-  if (--_limitCheckCount > 0) {
+  // Helper threads are stopped by the main thread
+  if (_threadId != 0 || --_limitCheckCount > 0) {
     return false;
   }
 
   _limitCheckCount = 4096;
 
-  int elapsed =
-      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start).count();
+  int elapsed = _getElapsed();
 
-  if (_limits.nodes != 0 && (_nodes >= _limits.nodes)) return true;
+  if (_limits.nodes != 0 && (getNodes() >= static_cast<unsigned long long>(_limits.nodes))) return true;
   if (elapsed >= (_timeAllocated)) return true;
 
   return false;
 }
 
-void Search::_rootMax(const Board &board, int depth) {
-  MoveGen movegen(board);
-  MoveList legalMoves = movegen.getLegalMoves();
-  _nodes = 0;
+int Search::_rootMax(Board &board, int depth, int alpha, int beta) {
+  _pvLength[0] = 0;
+  _orderingInfo.setPv(board, _pv);
+
+  MoveList moves;
+  GeneralMovePicker movePicker
+      (&_orderingInfo, &board, &moves);
 
   // If no legal moves are available, just return, setting bestmove to a null move
-  if (legalMoves.empty()) {
+  if (!movePicker.hasNext()) {
     _bestMove = Move();
     _bestScore = -INF;
-    return;
+    return -INF;
   }
 
-  GeneralMovePicker movePicker
-      (&_orderingInfo, const_cast<Board *>(&board), &legalMoves);
-
-  int alpha = -INF;
-  int beta = INF;
-
+  int alphaOrig = alpha;
   int currScore;
 
   Move bestMove;
+  Move firstMove;
   bool fullWindow = true;
   while (movePicker.hasNext()) {
     Move move = movePicker.getNext();
+    if (firstMove.getFlags() & Move::NULL_MOVE) {
+      firstMove = move;
+    }
 
-    Board movedBoard = board;
-    movedBoard.doMove(move);
+    UndoInfo undoInfo = board.doMove(move);
 
     _orderingInfo.incrementPly();
     if (fullWindow) {
-      currScore = -_negaMax(movedBoard, depth - 1, -beta, -alpha);
+      currScore = -_negaMax(board, depth - 1, -beta, -alpha);
     } else {
-      currScore = -_negaMax(movedBoard, depth - 1, -alpha - 1, -alpha);
-      if (currScore > alpha) currScore = -_negaMax(movedBoard, depth - 1, -beta, -alpha);
+      currScore = -_negaMax(board, depth - 1, -alpha - 1, -alpha);
+      if (currScore > alpha) currScore = -_negaMax(board, depth - 1, -beta, -alpha);
     }
     _orderingInfo.deincrementPly();
 
+    board.undoMove(move, undoInfo);
+
     if (_stop || _checkLimits()) {
       _stop = true;
       break;
@@ -192,9 +384,10 @@ void Search::_rootMax(const Board &board, int depth) {
       fullWindow = false;
       bestMove = move;
       alpha = currScore;
+      _updatePv(0, move);
 
-      // Break if we've found a checkmate
-      if (currScore == INF) {
+      // Break if we've failed high (or found a checkmate in a full window search)
+      if (currScore >= beta) {
         break;
       }
     }
@@ -202,28 +395,50 @@ void Search::_rootMax(const Board &board, int depth) {
 
   // If the best move was not set in the main search loop
   // alpha was not raised at any point, just pick the first move
-  // avaliable (arbitrary) to avoid putting a null move in the
+  // searched (arbitrary) to avoid putting a null move in the
   // transposition table
   if (bestMove.getFlags() & Move::NULL_MOVE) {
-    bestMove = legalMoves.at(0);
+    bestMove = firstMove;
   }
 
-  if (!_stop) {
-    TranspTableEntry ttEntry(alpha, depth, TranspTableEntry::EXACT, bestMove);
-    _tt.set(board.getZKey(), ttEntry);
+  // A fail low of an aspiration window gives no information about which move
+  // is best, so the best move of the previous search is kept until a
+  // re-search finds a better one
+  if (!_stop && (alpha > alphaOrig || alphaOrig == -INF)) {
+    TranspTableEntry::Flag flag = alpha >= beta ? TranspTableEntry::LOWER_BOUND : TranspTableEntry::EXACT;
+    TranspTableEntry ttEntry(alpha, depth, flag, bestMove);
+    _tt->set(board.getZKey(), ttEntry);
 
     _bestMove = bestMove;
     _bestScore = alpha;
+
+    _pv.clear();
+    if (_pvLength[0] == 0) {
+      _pv.push_back(bestMove);
+    }
+    for (int i = 0; i < _pvLength[0]; i++) {
+      _pv.push_back(_pvTable[0][i]);
+    }
   }
+
+  return alpha;
 }
 
-int Search::_negaMax(const Board &board, int depth, int alpha, int beta) {
+int Search::_negaMax(Board &board, int depth, int alpha, int beta, bool allowNull) {
+  int ply = _orderingInfo.getPly();
+  _pvLength[ply] = 0;
+
   // Check search limits
   if (_stop || _checkLimits()) {
     _stop = true;
     return 0;
   }
 
+  // Don't search past the end of the per ply tables
+  if (ply >= MAX_PLY - 1) {
+    return _qSearch(board, alpha, beta);
+  }
+
   // Check for threefold repetition draws
   if (std::find(_positionHistory.begin(), _positionHistory.end(), board.getZKey()) != _positionHistory.end()) {
     return 0;
@@ -235,64 +450,127 @@ int Search::_negaMax(const Board &board, int depth, int alpha, int beta) {
   }
 
   int alphaOrig = alpha;
-  const TranspTableEntry *ttEntry = _tt.getEntry(board.getZKey());
-  // Check transposition table cache
-  if (ttEntry && (ttEntry->getDepth() >= depth)) {
-    switch (ttEntry->getFlag()) {
-      case TranspTable::EXACT:return ttEntry->getScore();
-      case TranspTable::UPPER_BOUND:beta = std::min(beta, ttEntry->getScore());
+  TranspTableEntry ttEntry;
+  // Check transposition table cache (except at PV nodes, where cutoffs would
+  // truncate the principal variation). The window width is calculated with
+  // 64 bits as it overflows an int for windows bounded by INF.
+  bool pvNode = static_cast<long long>(beta) - alpha > 1;
+  if (!pvNode && _tt->probe(board.getZKey(), ttEntry) && (ttEntry.getDepth() >= depth)) {
+    switch (ttEntry.getFlag()) {
+      case TranspTable::EXACT:return ttEntry.getScore();
+      case TranspTable::UPPER_BOUND:beta = std::min(beta, ttEntry.getScore());
         break;
-      case TranspTable::LOWER_BOUND:alpha = std::max(alpha, ttEntry->getScore());
+      case TranspTable::LOWER_BOUND:alpha = std::max(alpha, ttEntry.getScore());
         break;
     }
 
     if (alpha >= beta) {
-      return ttEntry->getScore();
+      return ttEntry.getScore();
     }
   }
 
-  // Transposition table lookups are inconclusive, generate moves and recurse
-  MoveGen movegen(board);
-  MoveList legalMoves = movegen.getLegalMoves();
-
-  // Check for checkmate and stalemate
-  if (legalMoves.empty()) {
-    int score = board.colorIsInCheck(board.getActivePlayer()) ? -INF : 0; // -INF = checkmate, 0 = stalemate (draw)
-    return score;
-  }
-
   // Extend when evading check
-  int checkExtension = 0;
-  if (board.colorIsInCheck(board.getActivePlayer())) {
-    checkExtension = 1;
-  }
+  bool inCheck = board.colorIsInCheck(board.getActivePlayer());
+  int checkExtension = inCheck ? 1 : 0;
 
-  // Eval if depth is 0
+  // Eval if depth is 0 (quiescence search also detects checkmate and stalemate)
   if ((depth + checkExtension) == 0) {
     return _qSearch(board, alpha, beta);
   }
 
+  // Null move pruning: if passing the turn still fails high in a reduced depth
+  // search, a real move almost certainly will too
+  if (allowNull && !inCheck && depth >= NULL_MOVE_MIN_DEPTH && !pvNode && _canNullMove(board)) {
+    int reduction = NULL_MOVE_REDUCTION + depth / NULL_MOVE_REDUCTION_DIVISOR;
+
+    UndoInfo undoInfo = board.doNullMove();
+    _orderingInfo.incrementPly();
+    int score = -_negaMax(board, std::max(depth - 1 - reduction, 0), -beta, -beta + 1, false);
+    _orderingInfo.deincrementPly();
+    board.undoNullMove(undoInfo);
+
+    if (_stop) {
+      return 0;
+    }
+
+    if (score >= beta) {
+      // Verify cutoffs at high depths with a reduced search of our own moves,
+      // guarding against zugzwang positions that aren't pawn endgames
+      if (depth < NULL_MOVE_VERIFY_DEPTH) {
+        return beta;
+      }
+
+      int verifyScore = _negaMax(board, depth - reduction, beta - 1, beta, false);
+      if (_stop) {
+        return 0;
+      }
+      if (verifyScore >= beta) {
+        return beta;
+      }
+    }
+  }
+
+  // Transposition table lookups are inconclusive, pick moves (generating
+  // them only as needed) and recurse
+  MoveList moves;
   GeneralMovePicker movePicker
-      (&_orderingInfo, const_cast<Board *>(&board), &legalMoves);
+      (&_orderingInfo, &board, &moves);
+
+  // Check for checkmate and stalemate
+  if (!movePicker.hasNext()) {
+    return inCheck ? -INF : 0; // -INF = checkmate, 0 = stalemate (draw)
+  }
 
   Move bestMove;
+  Move firstMove;
   bool fullWindow = true;
+  int movesSearched = 0;
   while (movePicker.hasNext()) {
     Move move = movePicker.getNext();
+    if (firstMove.getFlags() & Move::NULL_MOVE) {
+      firstMove = move;
+    }
 
-    Board movedBoard = board;
-    movedBoard.doMove(move);
+    UndoInfo undoInfo = board.doMove(move);
+    movesSearched++;
 
-    int score;
+    int newDepth = depth - 1 + checkExtension;
+    int score = 0;
+    bool fullDepth = true;
     _orderingInfo.incrementPly();
-    if (fullWindow) {
-      score = -_negaMax(movedBoard, depth - 1 + checkExtension, -beta, -alpha);
-    } else {
-      score = -_negaMax(movedBoard, depth - 1 + checkExtension, -alpha - 1, -alpha);
-      if (score > alpha) score = -_negaMax(movedBoard, depth - 1 + checkExtension, -beta, -alpha);
+
+    // Late move reductions for quiet moves that don't evade or give check
+    if (movePicker.pickedQuiet() && !inCheck && depth >= LMR_MIN_DEPTH &&
+        !board.colorIsInCheck(board.getActivePlayer())) {
+      int reduction = std::min(_lmrTable[std::min(depth, LMR_TABLE_SIZE - 1)][std::min(movesSearched, LMR_TABLE_SIZE - 1)],
+                               newDepth - 1);
+
+      if (reduction > 0) {
+        score = -_negaMax(board, newDepth - reduction, -alpha - 1, -alpha);
+
+        // Re-search at full depth if the reduced search fails high
+        fullDepth = score > alpha;
+      }
+    }
+
+    if (fullDepth) {
+      if (fullWindow) {
+        score = -_negaMax(board, newDepth, -beta, -alpha);
+      } else {
+        score = -_negaMax(board, newDepth, -alpha - 1, -alpha);
+        if (score > alpha) score = -_negaMax(board, newDepth, -beta, -alpha);
+      }
     }
     _orderingInfo.deincrementPly();
 
+    board.undoMove(move, undoInfo);
+
+    // Scores of aborted searches are meaningless and must not reach the
+    // killers, history or transposition table
+    if (_stop) {
+      return 0;
+    }
+
     // Beta cutoff
     if (score >= beta) {
       // Add this move as a new killer move and update history if move is quiet
@@ -303,7 +581,7 @@ int Search::_negaMax(const Board &board, int depth, int alpha, int beta) {
 
       // Add a new tt entry for this node
       TranspTableEntry newTTEntry(score, depth, TranspTableEntry::LOWER_BOUND, move);
-      _tt.set(board.getZKey(), newTTEntry);
+      _tt->set(board.getZKey(), newTTEntry);
       return beta;
     }
 
@@ -312,15 +590,16 @@ int Search::_negaMax(const Board &board, int depth, int alpha, int beta) {
       fullWindow = false;
       alpha = score;
       bestMove = move;
+      _updatePv(ply, move);
     }
   }
 
   // If the best move was not set in the main search loop
   // alpha was not raised at any point, just pick the first move
-  // avaliable (arbitrary) to avoid putting a null move in the
+  // searched (arbitrary) to avoid putting a null move in the
   // transposition table
   if (bestMove.getFlags() & Move::NULL_MOVE) {
-    bestMove = legalMoves.at(0);
+    bestMove = firstMove;
   }
 
   // Store bestScore in transposition table
@@ -331,54 +610,102 @@ int Search::_negaMax(const Board &board, int depth, int alpha, int beta) {
     flag = TranspTableEntry::EXACT;
   }
   TranspTableEntry newTTEntry(alpha, depth, flag, bestMove);
-  _tt.set(board.getZKey(), newTTEntry);
+  _tt->set(board.getZKey(), newTTEntry);
 
   return alpha;
 }
 
-int Search::_qSearch(const Board &board, int alpha, int beta) {
+int Search::_lmrTable[LMR_TABLE_SIZE][LMR_TABLE_SIZE];
+
+void Search::initLmrTable(int base, int divisor) {
+  for (int depth = 0; depth < LMR_TABLE_SIZE; depth++) {
+    for (int moveNumber = 0; moveNumber < LMR_TABLE_SIZE; moveNumber++) {
+      if (depth == 0 || moveNumber == 0) {
+        _lmrTable[depth][moveNumber] = 0;
+        continue;
+      }
+
+      double reduction = base / 100.0 + std::log(depth) * std::log(moveNumber) / (std::max(divisor, 1) / 100.0);
+      _lmrTable[depth][moveNumber] = static_cast<int>(std::min(std::max(reduction, 0.0), double(LMR_TABLE_SIZE)));
+    }
+  }
+}
+
+bool Search::_canNullMove(const Board &board) const {
+  Color color = board.getActivePlayer();
+  U64 nonPawnMaterial = board.getAllPieces(color) & ~(board.getPieces(color, PAWN) | board.getPieces(color, KING));
+
+  return nonPawnMaterial != ZERO;
+}
+
+int Search::_evaluate(const Board &board) {
+  int score;
+  if (!_evalCache->probe(board.getZKey(), score)) {
+    if (_accumulators) {
+      score = Nnue::evaluate(board);
+    } else {
+      score = Eval::evaluate(board, board.getActivePlayer(), &_pawnTable);
+    }
+    _evalCache->store(board.getZKey(), score);
+  }
+  return score;
+}
+
+int Search::_qSearch(Board &board, int alpha, int beta, int qPly) {
   // Check search limits
   if (_stop || _checkLimits()) {
     _stop = true;
     return 0;
   }
 
-  MoveGen movegen(board);
-  MoveList legalMoves = movegen.getLegalMoves();
+  _nodes++;
 
-  // Check for checkmate / stalemate
-  if (legalMoves.empty()) {
-    if (board.colorIsInCheck(board.getActivePlayer())) { // Checkmate
-      return -INF;
-    } else { // Stalemate
-      return 0;
-    }
+  // Stop long sequences of checks and evasions
+  if (qPly >= MAX_QSEARCH_PLY) {
+    return _evaluate(board);
   }
 
-  int standPat = Eval::evaluate(board, board.getActivePlayer());
-  _nodes++;
+  MoveList moves;
+  bool inCheck = board.colorIsInCheck(board.getActivePlayer());
+  if (inCheck) {
+    // Search all evasions when in check (there is no stand pat option)
+    MoveGen::genLegalMoves(board, moves, MoveGen::EVASIONS);
 
-  QSearchMovePicker movePicker(&legalMoves);
+    // Checkmate
+    if (moves.empty()) {
+      return -INF;
+    }
+  } else {
+    // Only captures and promotions are searched otherwise
+    MoveGen::genLegalMoves(board, moves, MoveGen::CAPTURES);
 
-  // If node is quiet, just return eval
-  if (!movePicker.hasNext()) {
-    return standPat;
-  }
+    // If node is quiet, just return eval (or 0 if it's stalemate)
+    if (moves.empty()) {
+      return MoveGen::hasLegalMoves(board) ? _evaluate(board) : 0;
+    }
 
-  if (standPat >= beta) {
-    return beta;
-  }
-  if (alpha < standPat) {
-    alpha = standPat;
+    int standPat = _evaluate(board);
+
+    if (standPat >= beta) {
+      return beta;
+    }
+    if (alpha < standPat) {
+      alpha = standPat;
+    }
   }
 
+  QSearchMovePicker movePicker(&moves);
   while (movePicker.hasNext()) {
     Move move = movePicker.getNext();
 
-    Board movedBoard = board;
-    movedBoard.doMove(move);
+    // Captures losing material are very unlikely to raise alpha
+    if (!inCheck && MovePicker::isLosingCapture(board, move)) {
+      continue;
+    }
 
-    int score = -_qSearch(movedBoard, -beta, -alpha);
+    UndoInfo undoInfo = board.doMove(move);
+    int score = -_qSearch(board, -beta, -alpha, qPly + 1);
+    board.undoMove(move, undoInfo);
 
     if (score >= beta) {
       return beta;
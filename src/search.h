@@ -6,8 +6,13 @@
 #include "movegen.h"
 #include "transptable.h"
 #include "orderinginfo.h"
+#include "pawnstructuretable.h"
+#include "evalcache.h"
+#include "nnue.h"
 #include <chrono>
 #include <atomic>
+#include <memory>
+#include <mutex>
 
 /**
  * @brief Represents a search through a minmax tree.
@@ -70,13 +75,26 @@ class Search {
    * @param limits limits imposed on this search
    * @param positionHistory Vector of ZKeys reprenting all positions that have
    * occurred in the game
+   * @param tt Transposition table to use (this persists between searches)
    * @param logUci If logUci is set, UCI info commands about the search will be printed
    * to standard output in real time.k
+   * @param threads Number of threads to search with (see iterDeep())
    */
-  Search(const Board &, Limits, std::vector<ZKey>, bool= true);
+  Search(const Board &, Limits, std::vector<ZKey>, TranspTable *, bool= true, int= 1);
+
+  /**
+   * @brief Destroys this Search, returning its evaluation caches for reuse by later searches.
+   */
+  ~Search();
 
   /**
    * @brief Performs an iterative deepening search within the constraints of the given limits.
+   *
+   * If this search was created with more than one thread, helper threads
+   * (Lazy SMP) search the same position in parallel with their own move
+   * ordering information, sharing results only through the transposition
+   * table. The best move is always the one found by the calling (main)
+   * thread, and helpers are stopped when it finishes.
    */
   void iterDeep();
 
@@ -86,11 +104,93 @@ class Search {
    */
   Move getBestMove();
 
+  /**
+   * @brief Returns the principal variation of the last completed iteration of
+   * the last search performed.
+   *
+   * @return The principal variation, starting with the best move
+   */
+  const MoveList &getPv() const;
+
   /**
    * @brief Instructs this Search to stop as soon as possible.
    */
   void stop();
 
+  /**
+   * @brief Returns the number of nodes searched so far by all threads of this search.
+   *
+   * @return The number of nodes searched so far by all threads of this search
+   */
+  unsigned long long getNodes() const;
+
+  /**
+   * @brief Returns the fraction of evaluation cache probes that found an
+   * evaluation, over all threads of this search.
+   *
+   * This should only be called when no search is running.
+   *
+   * @return The evaluation cache hit rate (0 if the cache hasn't been probed)
+   */
+  double getEvalCacheHitRate() const;
+
+  /**
+   * @brief Sets the size of the evaluation cache of each thread of searches
+   * created after this call.
+   *
+   * Unused caches are freed immediately, and caches of existing searches
+   * when those searches are destroyed.
+   *
+   * @param sizeMb Size of each evaluation cache in megabytes
+   */
+  static void setEvalCacheSize(int= EvalCache::DEFAULT_SIZE_MB);
+
+  /**
+   * @brief Removes all evaluations from the evaluation caches kept for reuse
+   * by later searches.
+   *
+   * Caches of existing searches are freed when those searches are destroyed
+   * instead of being reused. This must be called whenever the evaluation
+   * function changes (eg. a new network is loaded).
+   */
+  static void clearEvalCaches();
+
+  /**
+   * @brief Selects the evaluation used by searches created after this call.
+   *
+   * If NNUE evaluation is selected but no network has been loaded (see
+   * Nnue::load()), the classical evaluation is used. Evaluation caches are
+   * cleared if the selected evaluation changes.
+   *
+   * @param useNnue true to use NNUE evaluation, false to use the classical evaluation
+   */
+  static void setUseNnue(bool);
+
+  /**
+   * @name Default late move reduction parameters
+   *
+   * Parameters are given in hundredths (see initLmrTable()).
+   *
+   * @{
+   */
+  static const int DEFAULT_LMR_BASE = 75;
+  static const int DEFAULT_LMR_DIVISOR = 225;
+  /**@}*/
+
+  /**
+   * @brief Calculates the table of late move reductions used by all searches.
+   *
+   * A quiet move searched after moveNumber other moves with depth plys
+   * remaining is reduced by base + ln(depth) * ln(moveNumber) / divisor plys
+   * (rounded down). This must be called (with the default parameters if no
+   * others are needed) before any search is performed, and must not be called
+   * while a search is running.
+   *
+   * @param base    Base reduction in hundredths of a ply
+   * @param divisor Divisor of ln(depth) * ln(moveNumber) in hundredths
+   */
+  static void initLmrTable(int= DEFAULT_LMR_BASE, int= DEFAULT_LMR_DIVISOR);
+
  private:
   /**
    * @brief Default depth to search to if no limits are specified.
@@ -110,6 +210,114 @@ class Search {
    */
   static const int MAX_SEARCH_DEPTH = 20;
 
+  /**
+   * @name Null move pruning parameters
+   *
+   * - NULL_MOVE_MIN_DEPTH - Minimum remaining depth at which null moves are tried
+   * - NULL_MOVE_REDUCTION - Depth reduction (R) of the null move search, in addition to the null move itself
+   * - NULL_MOVE_REDUCTION_DIVISOR - R is increased by 1 for every NULL_MOVE_REDUCTION_DIVISOR plys of remaining depth
+   * - NULL_MOVE_VERIFY_DEPTH - Minimum remaining depth at which null move cutoffs
+   *   are verified by a reduced depth search without null moves
+   *
+   * @{
+   */
+  static const int NULL_MOVE_MIN_DEPTH = 3;
+  static const int NULL_MOVE_REDUCTION = 2;
+  static const int NULL_MOVE_REDUCTION_DIVISOR = 6;
+  static const int NULL_MOVE_VERIFY_DEPTH = 8;
+  /**@}*/
+
+  /**
+   * @name Aspiration window parameters
+   *
+   * - ASPIRATION_MIN_DEPTH - Minimum depth at which iterations are searched with an aspiration window
+   * - ASPIRATION_WINDOW - Initial distance of each side of the window from the previous iteration's score
+   * - ASPIRATION_MAX_WINDOW - The failing side of the window is opened completely once
+   *   it would be further than this from the returned score
+   *
+   * @{
+   */
+  static const int ASPIRATION_MIN_DEPTH = 5;
+  static const int ASPIRATION_WINDOW = 25;
+  static const int ASPIRATION_MAX_WINDOW = 1000;
+  /**@}*/
+
+  /**
+   * @brief Minimum remaining depth at which late move reductions are made.
+   */
+  static const int LMR_MIN_DEPTH = 3;
+
+  /**
+   * @brief Size of each dimension of the late move reduction table.
+   *
+   * Larger depths and move numbers use the reductions of the last entries.
+   */
+  static const int LMR_TABLE_SIZE = 64;
+
+  /**
+   * @brief Table indexed by [depth][moveNumber] of late move reductions (see initLmrTable()).
+   */
+  static int _lmrTable[LMR_TABLE_SIZE][LMR_TABLE_SIZE];
+
+  /**
+   * @brief Size in megabytes of the evaluation cache of each search thread (see setEvalCacheSize()).
+   */
+  static int _evalCacheSizeMb;
+
+  /**
+   * @brief Evaluation caches of destroyed searches, kept for reuse.
+   *
+   * Each search thread owns its own evaluation cache while it exists. Like
+   * the transposition table, caches (and their evaluations) are then kept
+   * for later searches, so that a new cache doesn't have to be allocated
+   * and zeroed for every thread of every search.
+   */
+  struct EvalCachePool {
+    /**
+     * @brief Evaluation caches not owned by any search
+     */
+    std::vector<std::unique_ptr<EvalCache>> idle;
+
+    /**
+     * @brief Incremented whenever evaluation caches of existing searches may
+     * no longer be reused (because their size or the evaluation changed).
+     */
+    unsigned int generation = 0;
+
+    /**
+     * @brief Guards idle and generation.
+     */
+    std::mutex mutex;
+  };
+
+  /**
+   * @brief Returns the pool of idle evaluation caches.
+   *
+   * The pool is never destroyed, so that searches destroyed during static
+   * destruction (eg. the UCI interface's last search) can still return their
+   * caches to it.
+   *
+   * @return The pool of idle evaluation caches
+   */
+  static EvalCachePool &_getEvalCachePool();
+
+  /**
+   * @brief Takes an idle evaluation cache (or allocates a new one) for this
+   * search and resets its probe and hit counts.
+   */
+  void _acquireEvalCache();
+
+  /**
+   * @brief Returns this search's evaluation cache to the idle caches, or
+   * frees it if it may no longer be reused.
+   */
+  void _releaseEvalCache();
+
+  /**
+   * @brief True if searches should use NNUE evaluation (see setUseNnue()).
+   */
+  static bool _useNnue;
+
   /**
    * @brief Vector of ZKeys for each position that has occurred in the game
    * 
@@ -123,6 +331,31 @@ class Search {
    */
   OrderingInfo _orderingInfo;
 
+  /**
+   * @brief Pawn structure table used when evaluating positions in this search
+   *
+   * Each thread searches with its own Search object and thus its own pawn
+   * structure table.
+   */
+  PawnStructureTable _pawnTable;
+
+  /**
+   * @brief Cache of static evaluations used in quiescence search
+   *
+   * Each search thread has its own (see EvalCachePool).
+   */
+  std::unique_ptr<EvalCache> _evalCache;
+
+  /**
+   * @brief Generation of the evaluation cache pool when _evalCache was acquired.
+   */
+  unsigned int _evalCacheGeneration;
+
+  /**
+   * @brief NNUE accumulators attached to _initialBoard (nullptr if the classical evaluation is used)
+   */
+  std::unique_ptr<Nnue::AccumulatorStack> _accumulators;
+
   /**
    * @brief Limits object representing limits imposed on this search.
    * 
@@ -177,14 +410,14 @@ class Search {
   int _limitCheckCount;
 
   /**
-   * @brief Number of nodes searched in the last search.
+   * @brief Number of nodes searched by this thread in the current search.
    */
-  int _nodes;
+  std::atomic<unsigned long long> _nodes;
 
   /**
    * @brief Transposition Table used while searching.
    */
-  TranspTable _tt;
+  TranspTable *_tt;
 
   /**
    * @brief Best move found on last search.
@@ -196,41 +429,115 @@ class Search {
    */
   int _bestScore;
 
+  /**
+   * @brief Index of the thread this search runs on (0 for the main thread).
+   */
+  int _threadId;
+
+  /**
+   * @brief Helper searches run in parallel to this one by iterDeep().
+   *
+   * This is only populated for the main thread's search.
+   */
+  std::vector<std::unique_ptr<Search>> _helpers;
+
+  /**
+   * @brief Iterative deepening loop run by helper threads.
+   *
+   * Searches increasing depths until stopped by the main thread without
+   * logging UCI info.
+   */
+  void _helperIterDeep();
+
+  /**
+   * @brief Searches the initial board to the given depth using an aspiration window.
+   *
+   * The window is centered on the score of the previous iteration. If the
+   * search fails low or high, the failing side of the window is widened
+   * geometrically and the search is repeated until the score falls within the
+   * window (UCI info with an upperbound or lowerbound score is logged for each
+   * failed search).
+   *
+   * @param depth Depth to search to
+   */
+  void _aspirationSearch(int);
+
   /**
    * @brief Root negamax function.
    *
    * Starts performing a search to the given depth using recursive minimax
    * with alpha-beta pruning.
    *
+   * The best move and score are only updated if the search was not stopped
+   * and did not fail low (unless alpha is -INF).
+   *
    * @param board Board to search through
    * @param depth Depth to search to
+   * @param alpha Alpha value
+   * @param beta  Beta value
+   * @return The score of the given board (at most alpha on a fail low and at least beta on a fail high)
    */
-  void _rootMax(const Board &, int);
+  int _rootMax(Board &, int, int, int);
 
   /**
    * @brief Non root negamax function, should only be called by _rootMax()
    *
+   * At zero window nodes, a null move is tried first (if allowed) and the node
+   * is pruned if a reduced depth search after it still fails high. Late quiet
+   * moves are searched with reduced depth (see initLmrTable()) and re-searched
+   * at full depth if they fail high.
    *
-   * @param  board Board to search
-   * @param  depth Plys remaining to search
-   * @param  alpha Alpha value
-   * @param  beta  Beta value
+   * @param  board     Board to search
+   * @param  depth     Plys remaining to search
+   * @param  alpha     Alpha value
+   * @param  beta      Beta value
+   * @param  allowNull True if null move pruning may be tried at this node
+   * (false directly after a null move and in null move verification searches)
    * @return The score of the given board
    */
-  int _negaMax(const Board &, int, int, int);
+  int _negaMax(Board &, int, int, int, bool= true);
+
+  /**
+   * @brief Returns true if the side to move on the given board has pieces
+   * other than pawns and its king.
+   *
+   * Null moves are not tried when the side to move only has pawns left, as
+   * zugzwang is common in pawn endgames (nor in check, where passing would be
+   * illegal).
+   *
+   * @param board Board to check
+   * @return true if a null move may be tried, false otherwise
+   */
+  bool _canNullMove(const Board &) const;
 
   /**
    * @brief Performs a quiescence search
    *
    * _qSearch only takes into account captures (checks, promotions are not
-   * considered)
+   * considered). Captures that lose material according to static exchange
+   * evaluation are skipped unless the side to move is in check. Checkmate and
+   * stalemate are scored as at other nodes.
+   *
+   * As all evasions are searched when in check, lines of checks could be
+   * searched indefinitely, so nodes MAX_QSEARCH_PLY plys into the quiescence
+   * search just return their static evaluation.
    *
    * @param  board Board to perform a quiescence search on
    * @param  alpha Alpha value
    * @param  beta  Beta value
+   * @param  qPly  Number of plys searched by quiescence search so far
    * @return The score of the given board
    */
-  int _qSearch(const Board &, int= -INF, int= INF);
+  int _qSearch(Board &, int= -INF, int= INF, int= 0);
+
+  /**
+   * @brief Returns the static evaluation of the given board from the
+   * perspective of the side to move, using the evaluation cache.
+   *
+   * @param  board Board to evaluate
+   * @return The static evaluation of the given board
+   */
+  int _evaluate(const Board &);
 
   /**
    * @brief Logs info about a search according to the UCI protocol.
@@ -238,21 +545,46 @@ class Search {
    * @param pv        MoveList representing the Principal Variation (first moves at index 0)
    * @param depth     Depth of search
    * @param bestScore Score corresponding to the best move
+   * @param bound     Type of bound the score is (EXACT, LOWER_BOUND or UPPER_BOUND)
    * @param nodes     Number of nodes searched
    * @param elapsed   Time taken to complete the search in milliseconds
    */
-  void _logUciInfo(const MoveList &, int, int, int, int);
+  void _logUciInfo(const MoveList &, int, int, TranspTableEntry::Flag, unsigned long long, int);
 
   /**
-   * @brief Returns the principal variation for the last performed search.
-   * 
-   * Internally, this method probes the transposition table for the PV of the last
-   * performed search.
-   * 
-   * @param length Length of the principal variation
-   * @return MoveList The principal variation for the last performed search
+   * @brief Returns the number of milliseconds elapsed since this search was started.
+   *
+   * @return The number of milliseconds elapsed since this search was started
+   */
+  int _getElapsed() const;
+
+  /**
+   * @brief Triangular principal variation table.
+   *
+   * _pvTable[ply] contains the principal variation (of length _pvLength[ply])
+   * of the node currently being searched at that ply, with its first move at
+   * index 0. Each search thread has its own table.
+   */
+  Move _pvTable[MAX_PLY][MAX_PLY];
+
+  /**
+   * @brief Array indexed by ply of the lengths of the principal variations in _pvTable
+   */
+  int _pvLength[MAX_PLY];
+
+  /**
+   * @brief Principal variation of the last completed root search, starting with _bestMove.
+   */
+  MoveList _pv;
+
+  /**
+   * @brief Sets the principal variation at the given ply to the given move
+   * followed by the principal variation of the child node at the next ply.
+   *
+   * @param ply  Ply of the node whose alpha was raised
+   * @param move Move that raised alpha
    */
-  MoveList _getPv(int);
+  void _updatePv(int, Move);
 };
 
 #endif
@@ -0,0 +1,35 @@
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <cstddef>
+
+/**
+ * @brief A fixed size array that can be filled in by constexpr functions.
+ *
+ * std::array can't be modified in constant expressions in C++14, so lookup
+ * tables that are calculated at compile time (and thus stored as read only
+ * data in the executable) are built as Tables instead.
+ *
+ * Tables are indexed the same way as built in arrays. Multidimensional tables
+ * are made by nesting Tables (eg. Table<Table<U64, 64>, 8> is equivalent to
+ * U64[8][64]).
+ */
+template<typename T, std::size_t N>
+struct Table {
+  /**
+   * @brief Values in this table
+   */
+  T values[N];
+
+  /**
+   * @name Element access
+   * @brief Returns the value at the given index (no bounds checking is performed).
+   *
+   * @{
+   */
+  constexpr T &operator[](std::size_t index) { return values[index]; }
+  constexpr const T &operator[](std::size_t index) const { return values[index]; }
+  /**@}*/
+};
+
+#endif
@@ -1,24 +1,144 @@
 #include "transptable.h"
-#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
 
-void TranspTable::set(const ZKey &key, TranspTableEntry entry) {
-  auto insertResult = _table.insert(std::make_pair(key.getValue(), entry));
+TranspTable::TranspTable(int sizeMb) : _table(nullptr), _memory(nullptr), _numBuckets(0), _generation(0) {
+  resize(sizeMb);
+}
+
+TranspTable::~TranspTable() {
+  _free();
+}
+
+void TranspTable::_free() {
+  for (U64 i = 0; i < _numBuckets; i++) {
+    _table[i].~Bucket();
+  }
+  std::free(_memory);
+
+  _table = nullptr;
+  _memory = nullptr;
+  _numBuckets = 0;
+}
+
+void TranspTable::resize(int sizeMb) {
+  _free();
+
+  U64 maxBuckets = (static_cast<U64>(std::max(sizeMb, 1)) * 1024 * 1024) / sizeof(Bucket);
+  U64 numBuckets = ONE;
+  while (numBuckets * 2 <= maxBuckets) {
+    numBuckets *= 2;
+  }
+
+  // Over allocate so that buckets can be aligned to cache lines
+  _memory = std::malloc(numBuckets * sizeof(Bucket) + 63);
+  if (_memory == nullptr) {
+    fatal("Could not allocate " + std::to_string(sizeMb) + "MB for the transposition table");
+  }
+  _table = reinterpret_cast<Bucket *>((reinterpret_cast<std::uintptr_t>(_memory) + 63) & ~std::uintptr_t(63));
 
-  // If insertion was prevented due to the key already existing, overwrite the value
-  if (!insertResult.second) {
-    insertResult.first->second = entry;
+  // Construct the buckets (and their atomics) in the allocated memory
+  for (U64 i = 0; i < numBuckets; i++) {
+    new(&_table[i]) Bucket();
   }
+  _numBuckets = numBuckets;
+
+  clear();
 }
 
 void TranspTable::clear() {
-  _table.clear();
+  for (U64 i = 0; i < _numBuckets; i++) {
+    for (Slot &slot : _table[i].slots) {
+      slot.keyXorData.store(ZERO, std::memory_order_relaxed);
+      slot.data.store(ZERO, std::memory_order_relaxed);
+    }
+  }
+  _generation = 0;
+}
+
+void TranspTable::newSearch() {
+  _generation = (_generation + 1) & GENERATION_MASK;
+}
+
+unsigned int TranspTable::_getAge(U64 data) const {
+  return (_generation - static_cast<unsigned int>(data >> GENERATION_SHIFT)) & GENERATION_MASK;
+}
+
+TranspTable::Bucket *TranspTable::_getBucket(U64 key) const {
+  return &_table[key & (_numBuckets - 1)];
+}
+
+U64 TranspTable::_pack(const TranspTableEntry &entry) const {
+  int score = std::max(-INT16_MAX, std::min(entry.getScore(), static_cast<int>(INT16_MAX)));
+  int depth = std::max(0, std::min(entry.getDepth(), 255));
+
+  return static_cast<U64>(entry.getBestMove().getMoveInt()) |
+      (static_cast<U64>(static_cast<uint16_t>(score)) << SCORE_SHIFT) |
+      (static_cast<U64>(depth) << DEPTH_SHIFT) |
+      (static_cast<U64>(entry.getFlag() + 1) << FLAG_SHIFT) |
+      (static_cast<U64>(_generation) << GENERATION_SHIFT);
+}
+
+TranspTableEntry TranspTable::_unpack(U64 data) {
+  int score = static_cast<int16_t>((data >> SCORE_SHIFT) & 0xffff);
+  if (score == INT16_MAX) {
+    score = INF;
+  } else if (score == -INT16_MAX) {
+    score = -INF;
+  }
+
+  int depth = static_cast<int>((data >> DEPTH_SHIFT) & 0xff);
+  TranspTableEntry::Flag flag = static_cast<TranspTableEntry::Flag>(((data >> FLAG_SHIFT) & 0x3) - 1);
+  Move bestMove(static_cast<unsigned int>(data & 0xfffffff));
+
+  return TranspTableEntry(score, depth, flag, bestMove);
+}
+
+void TranspTable::set(const ZKey &key, TranspTableEntry entry) {
+  Bucket *bucket = _getBucket(key.getValue());
+  Slot *replace = &bucket->slots[0];
+  U64 replaceData = replace->data.load(std::memory_order_relaxed);
+
+  for (Slot &slot : bucket->slots) {
+    U64 data = slot.data.load(std::memory_order_relaxed);
+    U64 slotKey = slot.keyXorData.load(std::memory_order_relaxed) ^ data;
+
+    // Overwrite the existing entry for this key or the first empty slot
+    if (slotKey == key.getValue() || data == ZERO) {
+      replace = &slot;
+      break;
+    }
+
+    // Otherwise replace the oldest entry, or the shallowest if equally old
+    unsigned int age = _getAge(data);
+    unsigned int replaceAge = _getAge(replaceData);
+    if (age > replaceAge ||
+        (age == replaceAge && ((data >> DEPTH_SHIFT) & 0xff) < ((replaceData >> DEPTH_SHIFT) & 0xff))) {
+      replace = &slot;
+      replaceData = data;
+    }
+  }
+
+  U64 data = _pack(entry);
+  replace->keyXorData.store(key.getValue() ^ data, std::memory_order_relaxed);
+  replace->data.store(data, std::memory_order_relaxed);
 }
 
-const TranspTableEntry *TranspTable::getEntry(const ZKey &key) const {
-  auto got = _table.find(key.getValue());
-  if (got != _table.end()) {
-    return &_table.at(key.getValue());
-  } else {
-    return nullptr;
+bool TranspTable::probe(const ZKey &key, TranspTableEntry &entry) const {
+  const Bucket *bucket = _getBucket(key.getValue());
+
+  for (const Slot &slot : bucket->slots) {
+    U64 data = slot.data.load(std::memory_order_relaxed);
+
+    // If another thread wrote to this slot between the two loads, the key
+    // will not match and the (torn) entry is rejected
+    if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) == key.getValue() && data != ZERO) {
+      entry = _unpack(data);
+      return true;
+    }
   }
+
+  return false;
 }
@@ -4,7 +4,7 @@
 #include "board.h"
 #include "zkey.h"
 #include "transptableentry.h"
-#include <unordered_map>
+#include <atomic>
 
 /**
  * @brief A transposition table.
@@ -12,6 +12,21 @@
  * Each entry is mapped to by a ZKey and contains a score, depth and flag which
  * indicates if the stored score is an upper bound, lower bound or exact score.
  *
+ * The table is allocated once with a fixed size (in megabytes) and is made up
+ * of a power of two number of 64 byte buckets, each holding
+ * TranspTable::BUCKET_SIZE entries. A ZKey maps to exactly one bucket, so a
+ * probe touches a single cache line.
+ *
+ * Probing and storing entries is lock-free and safe to do concurrently from
+ * any number of threads. Each slot holds two 64 bit words: the packed entry
+ * data and the key xor'd with that data. An entry whose words were written
+ * by different threads (a torn entry) fails the key check on probe and is
+ * treated as a miss.
+ *
+ * The table is meant to persist between searches. Each entry records the
+ * generation (see newSearch()) it was written in, and when a bucket is full,
+ * entries from the oldest generation are replaced first, followed by entries
+ * searched to the lowest depth.
  */
 class TranspTable {
  public:
@@ -26,14 +41,43 @@ class TranspTable {
   };
 
   /**
-   * @brief Constructs a new empty transposition table.
+   * @brief Default size of a transposition table in megabytes.
+   */
+  static const int DEFAULT_SIZE_MB = 16;
+
+  /**
+   * @brief Maximum size of a transposition table in megabytes.
+   */
+  static const int MAX_SIZE_MB = 65536;
+
+  /**
+   * @brief Constructs a new empty transposition table of the given size.
+   *
+   * @param sizeMb Size of the table in megabytes (rounded down to a power of two
+   * number of buckets)
+   */
+  TranspTable(int= DEFAULT_SIZE_MB);
+
+  ~TranspTable();
+
+  TranspTable(const TranspTable &) = delete;
+  TranspTable &operator=(const TranspTable &) = delete;
+
+  /**
+   * @brief Reallocates this transposition table with the given size.
+   *
+   * All entries are discarded.
+   *
+   * @param sizeMb New size of the table in megabytes
    */
-  TranspTable() = default;;
+  void resize(int);
 
   /**
    * @brief Creates a new entry in the transposition table.
    *
-   * If the entry already exists, it will be overwritten.
+   * If an entry already exists for the given key, it will be overwritten.
+   * Otherwise an empty slot in the key's bucket is used, or if there is none,
+   * the oldest entry in the bucket (ties broken by lowest depth) is replaced.
    *
    * @param key Zobrist key of the board
    * @param entry Entry to store
@@ -41,26 +85,120 @@ class TranspTable {
   void set(const ZKey &, TranspTableEntry);
 
   /**
-   * @brief Get the entry in the transposition table for the given ZKey
-   * returns nullptr if no entry exists for the given ZKey.
+   * @brief Looks up the entry in the transposition table for the given ZKey.
    *
    * @param key ZKey to lookup entry for
-   * @return The transposition table entry corresponding to the given ZKey, or nullptr if it does not exist
+   * @param entry Set to the stored entry if one exists
+   * @return true if an entry exists for the given ZKey, false otherwise
    */
-  const TranspTableEntry *getEntry(const ZKey &) const;
+  bool probe(const ZKey &, TranspTableEntry &) const;
 
   /**
    * @brief Removes all entries from the transposition table.
    */
   void clear();
 
+  /**
+   * @brief Advances the generation of this transposition table.
+   *
+   * This should be called once at the start of every search so that entries
+   * left over from previous searches are replaced before current ones.
+   */
+  void newSearch();
+
  private:
   /**
-   * @brief The transposition table hash map.
+   * @brief Number of entries stored in each bucket.
+   */
+  static const int BUCKET_SIZE = 4;
+
+  /**
+   * @name Layout of the packed data word of each entry
+   *
+   * - Bits 0-27 - Best move (see Move::getMoveInt())
+   * - Bits 28-43 - Score (saturated to 16 bits, +/-INF preserved)
+   * - Bits 44-51 - Depth
+   * - Bits 52-53 - Flag + 1 (0 marks an empty slot)
+   * - Bits 54-59 - Generation
+   *
+   * @{
+   */
+  static const int SCORE_SHIFT = 28;
+  static const int DEPTH_SHIFT = 44;
+  static const int FLAG_SHIFT = 52;
+  static const int GENERATION_SHIFT = 54;
+  static const unsigned int GENERATION_MASK = 0x3f;
+  /**@}*/
+
+  /**
+   * @brief A single slot in a bucket, holding the full key (xor'd with the
+   * data) and packed entry data.
+   */
+  struct Slot {
+    std::atomic<U64> keyXorData;
+    std::atomic<U64> data;
+  };
+
+  /**
+   * @brief A cache line sized group of slots that a key maps to.
+   */
+  struct Bucket {
+    Slot slots[BUCKET_SIZE];
+  };
+  static_assert(sizeof(Bucket) == 64, "Transposition table buckets must fill exactly one cache line");
+
+  /**
+   * @brief Pointer to the (cache line aligned) first bucket of the table.
+   */
+  Bucket *_table;
+
+  /**
+   * @brief Memory allocated for the table (may be unaligned), in which
+   * _numBuckets buckets are constructed starting at _table.
+   */
+  void *_memory;
+
+  /**
+   * @brief Number of buckets in the table (always a power of two).
+   */
+  U64 _numBuckets;
+
+  /**
+   * @brief Current generation, stored with every entry written.
+   */
+  unsigned int _generation;
+
+  /**
+   * @brief Returns the number of generations that have passed since the
+   * given entry data was stored.
+   *
+   * @param data Packed data word of an entry
+   * @return The age of the entry in generations
+   */
+  unsigned int _getAge(U64) const;
+
+  /**
+   * @brief Returns the bucket that the given key maps to.
+   *
+   * @param key Key to get the bucket of
+   * @return The bucket that the given key maps to
+   */
+  Bucket *_getBucket(U64) const;
+
+  /**
+   * @brief Destroys all buckets and frees the memory allocated for the table.
+   */
+  void _free();
+
+  /**
+   * @name Packing functions converting between TranspTableEntry objects and
+   * the data word stored in each slot.
    *
-   * A map of ZKeys to a tuple of (score, depth, flag).
+   * @{
    */
-  std::unordered_map<U64, TranspTableEntry> _table;
+  U64 _pack(const TranspTableEntry &) const;
+  static TranspTableEntry _unpack(U64);
+  /**@}*/
 };
 
 #endif
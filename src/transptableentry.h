@@ -20,6 +20,11 @@ class TranspTableEntry {
     UPPER_BOUND
   };
 
+  /**
+   * @brief Construct an empty transposition table entry with a null best move.
+   */
+  TranspTableEntry() : _score(0), _depth(0), _flag(EXACT), _bestMove() {}
+
   /**
    * @brief Construct a new transposition table entry with the given score, depth,
    * type flag and best move.
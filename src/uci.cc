@@ -1,11 +1,78 @@
 #include <memory>
 #include "uci.h"
+#include "perft.h"
+#include "nnue.h"
 #include "version.h"
 #include <iostream>
 #include <thread>
 
 namespace {
+const int MAX_THREADS = 256;
+
+/**
+ * @name Default bench settings
+ *
+ * @{
+ */
+const int BENCH_DEPTH = 6;
+const int BENCH_THREADS = 1;
+const int BENCH_HASH_MB = 16;
+/**@}*/
+
+/**
+ * @brief Positions searched by the bench command.
+ *
+ * These cover openings, middlegames and endgames with a mix of quiet
+ * positions, tactics, promotions, castling and en passant. Don't change them
+ * without updating any recorded bench node counts.
+ */
+const char *BENCH_POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14",
+    "4rrk1/2p1b1p1/p1p3q1/4p3/2P2n1p/1P1NR2P/PB3PP1/3R1QK1 b - - 2 24",
+    "r3qbrk/6p1/2b2pPp/p3pP1Q/PpPpP2P/3P1B2/2PB3K/R5R1 w - - 16 42",
+    "6k1/1R3p2/6p1/2Bp3p/3P2q1/P7/1P2rQ1K/5R2 b - - 4 44",
+    "8/8/1p2k1p1/3p3p/1p1P1P1P/1P2PK2/8/8 w - - 3 54",
+    "7r/2p3k1/1p1p1qp1/1P1Bp3/p1P2r1P/P7/4R3/Q4RK1 w - - 0 36",
+    "r1bq1rk1/pp2b1pp/n1pp1n2/3P1p2/2P1p3/2N1P2N/PP2BPPP/R1BQ1RK1 b - - 2 10",
+    "3r3k/2r4p/1p1b3q/p4P2/P2Pp3/1B2P3/3BQ1RP/6K1 w - - 3 87",
+    "2r4r/1p4k1/1Pnp4/3Qb1pq/8/4BpPp/5P2/2RR1BK1 w - - 0 42",
+    "4q1bk/6b1/7p/p1p4p/PNPpP2P/KN4P1/3Q4/4R3 b - - 0 37",
+    "2q3r1/1r2pk2/pp3pp1/2pP3p/P1Pb1BbP/1P4Q1/R3NPP1/4R1K1 w - - 2 34",
+    "1r2r2k/1b4q1/pp5p/2pPp1p1/P3Pn2/1P1B1Q1P/2R3P1/4BR1K b - - 1 37",
+    "r3kbbr/pp1n1p1P/3ppnp1/q5N1/1P1pP3/P1N1B3/2P1QP2/R3KB1R b KQq b3 0 17",
+    "8/6pk/2b1Rp2/3r4/1R1B2PP/P5K1/8/2r5 b - - 16 42",
+    "1r4k1/4ppb1/2n1b1qp/pB4p1/1n1BP1P1/7P/2PNQPK1/3RN3 w - - 8 29",
+    "8/p2B4/PkP5/4p1pK/4Pb1p/5P2/8/8 w - - 29 68",
+    "3r4/ppq1ppkp/4bnp1/2pN4/2P1P3/1P4P1/PQ3PBP/R4K2 b - - 2 20",
+    "5rr1/4n2k/4q2P/P1P2n2/3B1p2/4pP2/2N1P3/1RR1K2Q w - - 1 49",
+    "1r5k/2pq2p1/3p3p/p1pP4/4QP2/PP1R3P/6PK/8 w - - 1 51",
+    "q5k1/5ppp/1r3bn1/1B6/P1N2P2/BQ2P1P1/5K1P/8 b - - 2 34",
+    "r1b2k1r/5n2/p4q2/1ppn1Pp1/3pp1p1/NP2P3/P1PPBK2/1RQN2R1 w - - 0 22",
+    "r1bqk2r/pppp1ppp/5n2/4b3/4P3/P1N5/1PP2PPP/R1BQKB1R w KQkq - 0 5",
+    "r1bqr1k1/pp1p1ppp/2p5/8/3N1Q2/P2BB3/1PP2PPP/R3K2n b Q - 1 12",
+    "r1bq2k1/p4r1p/1pp2pp1/3p4/1P1B3Q/P2B1N2/2P3PP/4R1K1 b - - 2 19",
+    "r4qk1/6r1/1p4p1/2ppBbN1/1p5Q/P7/2P3PP/5RK1 w - - 2 25",
+    "r7/6k1/1p6/2pp1p2/7Q/8/p1P2K1P/8 w - - 0 32",
+    "r3k2r/ppp1pp1p/2nqb1pn/3p4/4P3/2PP4/PP1NBPPP/R2QK1NR w KQkq - 1 5",
+    "3r1rk1/1pp1pn1p/p1n1q1p1/3p4/Q3P3/2P5/PP1NBPPP/4RRK1 w - - 0 12",
+    "5rk1/1pp1pn1p/p3Brp1/8/1n6/5N2/PP3PPP/2R2RK1 w - - 2 20",
+    "8/1p2pk1p/p1p1r1p1/3n4/8/5R2/PP3PPP/4R1K1 b - - 3 27",
+    "8/4pk2/1p1r2p1/p1p4p/Pn5P/3R4/1P3PP1/4RK2 w - - 1 33",
+    "8/5k2/1pnrp1p1/p1p4p/P6P/4R1PK/1P3P2/4R3 b - - 1 38",
+    "8/8/1p1kp1p1/p1pr1n1p/P6P/1R4P1/1P3PK1/1R6 b - - 15 45",
+    "8/8/1p1k2p1/p1prp2p/P2n3P/6P1/1P1R1PK1/4R3 b - - 5 49",
+    "8/k7/3p4/p2P1p2/P2P1P2/8/8/K7 w - - 0 1",
+    "6k1/6p1/8/6KQ/1r6/q2b4/8/8 w - - 0 32",
+};
+
 Book book;
+TranspTable tt;
 std::shared_ptr<Search> search;
 Board board;
 std::vector<ZKey> positionHistory;
@@ -22,14 +89,54 @@ void loadBook() {
   }
 }
 
+void loadEvalFile() {
+  if (Nnue::load(optionsMap["EvalFile"].getValue())) {
+    Search::clearEvalCaches();
+  } else {
+    std::cerr << optionsMap["EvalFile"].getValue() << " is inaccessible or isn't a valid network file" << std::endl;
+  }
+}
+
+void updateEvaluator() {
+  Search::setUseNnue(optionsMap["Use NNUE"].getValue() == "true");
+}
+
+void resizeHash() {
+  tt.resize(std::stoi(optionsMap["Hash"].getValue()));
+}
+
+void clearHash() {
+  tt.clear();
+}
+
+void resizeEvalCache() {
+  Search::setEvalCacheSize(std::stoi(optionsMap["Eval Cache"].getValue()));
+}
+
+void updateLmrTable() {
+  Search::initLmrTable(std::stoi(optionsMap["LMR Base"].getValue()), std::stoi(optionsMap["LMR Divisor"].getValue()));
+}
+
 void initOptions() {
   optionsMap["OwnBook"] = Option(false);
   optionsMap["BookPath"] = Option("book.bin", &loadBook);
+  optionsMap["Hash"] = Option(TranspTable::DEFAULT_SIZE_MB, 1, TranspTable::MAX_SIZE_MB, &resizeHash);
+  optionsMap["Clear Hash"] = Option(&clearHash);
+  optionsMap["Use NNUE"] = Option(false, &updateEvaluator);
+  optionsMap["EvalFile"] = Option("nn.bin", &loadEvalFile);
+  optionsMap["Eval Cache"] = Option(EvalCache::DEFAULT_SIZE_MB, 1, EvalCache::MAX_SIZE_MB, &resizeEvalCache);
+  optionsMap["Threads"] = Option(1, 1, MAX_THREADS);
+  optionsMap["LMR Base"] = Option(Search::DEFAULT_LMR_BASE, 0, 300, &updateLmrTable);
+  optionsMap["LMR Divisor"] = Option(Search::DEFAULT_LMR_DIVISOR, 100, 1000, &updateLmrTable);
+
+  updateLmrTable();
 }
 
 void uciNewGame() {
   board.setToStartPos();
   positionHistory.clear();
+  tt.clear();
+  Search::clearEvalCaches();
 }
 
 void setPosition(std::istringstream &is) {
@@ -54,7 +161,7 @@ void setPosition(std::istringstream &is) {
     }
 
     MoveGen movegen(board);
-    for (auto move : movegen.getMoves()) {
+    for (auto move : movegen.getLegalMoves()) {
       if (move.getNotation() == token) {
         board.doMove(move);
         positionHistory.push_back(board.getZKey());
@@ -88,47 +195,71 @@ void go(std::istringstream &is) {
     else if (token == "movestogo") is >> limits.movesToGo;
   }
 
-  search = std::make_shared<Search>(board, limits, positionHistory);
+  search = std::make_shared<Search>(board,
+                                    limits,
+                                    positionHistory,
+                                    &tt,
+                                    true,
+                                    std::stoi(optionsMap["Threads"].getValue()));
 
   std::thread searchThread(&pickBestMove);
   searchThread.detach();
 }
 
-unsigned long long perft(const Board &board, int depth) {
-  if (depth <= 0) {
-    return 1;
-  } else if (depth == 1) {
-    return MoveGen(board).getLegalMoves().size();
-  }
+void bench(std::istringstream &is) {
+  int depth = BENCH_DEPTH;
+  int threads = BENCH_THREADS;
+  int hashMb = BENCH_HASH_MB;
+  is >> depth >> threads >> hashMb;
 
-  MoveGen movegen(board);
+  // Every position gets cleared tables and fresh ordering information, so
+  // that with one thread the node count depends only on the engine itself
+  TranspTable benchTt(hashMb);
+  Search::Limits limits;
+  limits.depth = depth;
 
-  unsigned long long nodes = 0;
-  for (auto move : movegen.getLegalMoves()) {
-    Board movedBoard = board;
-    movedBoard.doMove(move);
+  unsigned long long totalNodes = 0;
+  double totalHitRate = 0;
+  int numPositions = sizeof(BENCH_POSITIONS) / sizeof(BENCH_POSITIONS[0]);
 
-    nodes += perft(movedBoard, depth - 1);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < numPositions; i++) {
+    Board benchBoard(BENCH_POSITIONS[i]);
+    benchTt.clear();
+    Search::clearEvalCaches();
+
+    Search benchSearch(benchBoard, limits, std::vector<ZKey>(), &benchTt, false, threads);
+    benchSearch.iterDeep();
+    totalNodes += benchSearch.getNodes();
+    totalHitRate += benchSearch.getEvalCacheHitRate();
+
+    std::cout << "Position " << (i + 1) << "/" << numPositions << ": ";
+    std::cout << benchSearch.getBestMove().getNotation() << " " << benchSearch.getNodes() << std::endl;
   }
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed = end - start;
 
-  return nodes;
+  std::cout << std::endl << "==========================" << std::endl;
+  std::cout << "Total time (ms) : " << static_cast<int>(elapsed.count() * 1000) << std::endl;
+  std::cout << "Nodes searched  : " << totalNodes << std::endl;
+  std::cout << "Nodes / second  : " << static_cast<unsigned long long>(totalNodes / elapsed.count()) << std::endl;
+  std::cout << "Eval cache hits : " << static_cast<int>(totalHitRate * 100 / numPositions) << "%" << std::endl;
 }
 
-void perftDivide(int depth) {
-  unsigned long long total = 0;
+void perftDivide(std::istringstream &is) {
+  int depth = 1;
+  int threads = 1;
+  int hashMb = 0;
+  is >> depth >> threads >> hashMb;
 
-  MoveGen movegen(board);
+  Perft perft(threads, hashMb);
+  unsigned long long total = 0;
 
   std::cout << std::endl;
   auto start = std::chrono::steady_clock::now();
-  for (auto move : movegen.getLegalMoves()) {
-    Board movedBoard = board;
-    movedBoard.doMove(move);
-
-    unsigned long long perftRes = perft(movedBoard, depth - 1);
-    total += perftRes;
-
-    std::cout << move.getNotation() << ": " << perftRes << std::endl;
+  for (auto rootCount : perft.divide(board, depth)) {
+    total += rootCount.second;
+    std::cout << rootCount.first.getNotation() << ": " << rootCount.second << std::endl;
   }
   auto end = std::chrono::steady_clock::now();
   std::chrono::duration<double> elapsed = end - start;
@@ -136,7 +267,7 @@ void perftDivide(int depth) {
   std::cout << std::endl << "==========================" << std::endl;
   std::cout << "Total time (ms) : " << static_cast<int>(elapsed.count() * 1000) << std::endl;
   std::cout << "Nodes searched  : " << total << std::endl;
-  std::cout << "Nodes / second  : " << static_cast<int>(total / elapsed.count()) << std::endl;
+  std::cout << "Nodes / second  : " << static_cast<unsigned long long>(total / elapsed.count()) << std::endl;
 }
 
 void printEngineInfo() {
@@ -148,7 +279,10 @@ void printEngineInfo() {
     std::cout << "option ";
     std::cout << "name " << optionPair.first << " ";
     std::cout << "type " << optionPair.second.getType() << " ";
-    std::cout << "default " << optionPair.second.getDefaultValue() << " ";
+
+    if (optionPair.second.getType() != "button") {
+      std::cout << "default " << optionPair.second.getDefaultValue() << " ";
+    }
 
     if (optionPair.second.getType() == "spin") {
       std::cout << "min " << optionPair.second.getMin() << " ";
@@ -162,12 +296,20 @@ void printEngineInfo() {
 void setOption(std::istringstream &is) {
   std::string token;
   std::string optionName;
+  std::string value;
 
-  is >> token >> optionName; // Advance past "name"
+  is >> token; // Advance past "name"
+
+  // Option names and values may contain spaces
+  while (is >> token && token != "value") {
+    optionName += (optionName.empty() ? "" : " ") + token;
+  }
+  while (is >> token) {
+    value += (value.empty() ? "" : " ") + token;
+  }
 
   if (optionsMap.find(optionName) != optionsMap.end()) {
-    is >> token >> token; // Advance past "value"
-    optionsMap[optionName].setValue(token);
+    optionsMap[optionName].setValue(value);
   } else {
     std::cout << "Invalid option" << std::endl;
   }
@@ -219,9 +361,9 @@ void loop() {
       }
       std::cout << std::endl;
     } else if (token == "perft") {
-      int depth = 1;
-      is >> depth;
-      perftDivide(depth);
+      perftDivide(is);
+    } else if (token == "bench") {
+      bench(is);
     } else {
       std::cout << "what?" << std::endl;
     }
@@ -1,43 +1,85 @@
 #include "zkey.h"
 #include "board.h"
 #include "bitutils.h"
-#include <random>
 #include <climits>
 #include <iostream>
 
-const unsigned int ZKey::PRNG_KEY = 0xDEADBEEF;
+namespace {
+/**
+ * @brief A constexpr implementation of std::mt19937_64.
+ */
+class Mt19937_64 {
+ public:
+  constexpr Mt19937_64(U64 seed) : _state{}, _index(STATE_SIZE) {
+    _state[0] = seed;
+    for (int i = 1; i < STATE_SIZE; i++) {
+      _state[i] = 6364136223846793005ULL * (_state[i - 1] ^ (_state[i - 1] >> 62)) + i;
+    }
+  }
 
-U64 ZKey::PIECE_KEYS[2][6][64];
-U64 ZKey::EN_PASSANT_KEYS[8];
+  constexpr U64 next() {
+    if (_index >= STATE_SIZE) {
+      _twist();
+    }
 
-U64 ZKey::KS_CASTLE_KEYS[2];
-U64 ZKey::QS_CASTLE_KEYS[2];
+    U64 y = _state[_index++];
+    y ^= (y >> 29) & 0x5555555555555555ULL;
+    y ^= (y << 17) & 0x71d67fffeda60000ULL;
+    y ^= (y << 37) & 0xfff7eee000000000ULL;
+    y ^= y >> 43;
 
-U64 ZKey::WHITE_TO_MOVE_KEY;
+    return y;
+  }
 
-void ZKey::init() {
-  std::mt19937_64 mt(PRNG_KEY);
-  std::uniform_int_distribution<U64> dist(ZERO, ULLONG_MAX);
+ private:
+  static const int STATE_SIZE = 312;
+  static const int SHIFT_SIZE = 156;
+  static const U64 LOWER_MASK = 0x7fffffffULL;
 
-  KS_CASTLE_KEYS[WHITE] = dist(mt);
-  QS_CASTLE_KEYS[WHITE] = dist(mt);
-  KS_CASTLE_KEYS[BLACK] = dist(mt);
-  QS_CASTLE_KEYS[BLACK] = dist(mt);
+  U64 _state[STATE_SIZE];
+  int _index;
 
-  WHITE_TO_MOVE_KEY = dist(mt);
+  constexpr void _twist() {
+    for (int i = 0; i < STATE_SIZE; i++) {
+      U64 x = (_state[i] & ~LOWER_MASK) | (_state[(i + 1) % STATE_SIZE] & LOWER_MASK);
+      U64 xA = x >> 1;
+      if (x & ONE) {
+        xA ^= 0xb5026f5aa96619e9ULL;
+      }
+      _state[i] = _state[(i + SHIFT_SIZE) % STATE_SIZE] ^ xA;
+    }
+    _index = 0;
+  }
+};
+}
+
+constexpr ZKey::Keys ZKey::_makeKeys() {
+  Mt19937_64 mt(PRNG_KEY);
+  Keys keys{};
+
+  keys.ksCastle[WHITE] = mt.next();
+  keys.qsCastle[WHITE] = mt.next();
+  keys.ksCastle[BLACK] = mt.next();
+  keys.qsCastle[BLACK] = mt.next();
+
+  keys.whiteToMove = mt.next();
 
   for (int file = 0; file < 8; file++) {
-    EN_PASSANT_KEYS[file] = dist(mt);
+    keys.enPassant[file] = mt.next();
   }
 
   for (int pieceType = 0; pieceType < 6; pieceType++) {
     for (int square = 0; square < 64; square++) {
-      PIECE_KEYS[WHITE][pieceType][square] = dist(mt);
-      PIECE_KEYS[BLACK][pieceType][square] = dist(mt);
+      keys.pieces[WHITE][pieceType][square] = mt.next();
+      keys.pieces[BLACK][pieceType][square] = mt.next();
     }
   }
+
+  return keys;
 }
 
+constexpr ZKey::Keys ZKey::KEYS = ZKey::_makeKeys();
+
 ZKey::ZKey() {
   _key = ZERO;
   _whiteKs = false, _whiteQs = false, _blackKs = false, _blackQs = false;
@@ -48,7 +90,7 @@ ZKey::ZKey(const Board &board) {
   _key = ZERO;
 
   if (board.getActivePlayer() == WHITE) {
-    _key ^= WHITE_TO_MOVE_KEY;
+    _key ^= KEYS.whiteToMove;
   }
 
   PieceType pieces[6] = {PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING};
@@ -71,7 +113,7 @@ ZKey::ZKey(const Board &board) {
   // Add en passant
   if (board.getEnPassant()) {
     _enPassantFile = (_bitscanForward(board.getEnPassant())) % 8;
-    _key ^= EN_PASSANT_KEYS[_enPassantFile];
+    _key ^= KEYS.enPassant[_enPassantFile];
   } else {
     _enPassantFile = -1;
   }
@@ -123,7 +165,7 @@ void ZKey::movePiece(Color color, PieceType piece, unsigned int from, unsigned i
 }
 
 void ZKey::flipPiece(Color color, PieceType piece, unsigned int index) {
-  _key ^= PIECE_KEYS[color][piece][index];
+  _key ^= KEYS.pieces[color][piece][index];
 }
 
 void ZKey::updateCastlingRights(bool whiteKs, bool whiteQs, bool blackKs, bool blackQs) {
@@ -147,26 +189,26 @@ void ZKey::updateCastlingRights(bool whiteKs, bool whiteQs, bool blackKs, bool b
 
 void ZKey::clearEnPassant() {
   if (_enPassantFile != -1) {
-    _key ^= EN_PASSANT_KEYS[_enPassantFile];
+    _key ^= KEYS.enPassant[_enPassantFile];
     _enPassantFile = -1;
   }
 }
 
 void ZKey::setEnPassantFile(unsigned int file) {
   _enPassantFile = file;
-  _key ^= EN_PASSANT_KEYS[file];
+  _key ^= KEYS.enPassant[file];
 }
 
 void ZKey::_flipKsCastle(Color color) {
-  _key ^= KS_CASTLE_KEYS[color];
+  _key ^= KEYS.ksCastle[color];
 }
 
 void ZKey::_flipQsCastle(Color color) {
-  _key ^= QS_CASTLE_KEYS[color];
+  _key ^= KEYS.qsCastle[color];
 }
 
 void ZKey::flipActivePlayer() {
-  _key ^= WHITE_TO_MOVE_KEY;
+  _key ^= KEYS.whiteToMove;
 }
 
 bool ZKey::operator==(const ZKey &other) {
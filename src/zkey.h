@@ -2,6 +2,7 @@
 #define ZKEY_H
 
 #include "defs.h"
+#include "table.h"
 
 class Board;
 
@@ -23,13 +24,6 @@ class ZKey {
    */
   ZKey(const Board &board);
 
-  /**
-   * @brief Initialize the pseudo-random values used to generate a ZKey.
-   *
-   * This must be called once prior to using the ZKey class.
-   */
-  static void init();
-
   /**
    * @brief Returns The value of this ZKey.
    *
@@ -135,34 +129,54 @@ class ZKey {
   /**@}*/
 
   /**
-   * @brief Array indexed by [Color][PieceType][SquareIndex] of pseudo-random
-   * values to xor into _key for each color, piece type and square.
+   * @brief Pseudo-random values used to generate a ZKey.
+   *
+   * These are generated at compile time with a constexpr implementation of
+   * std::mt19937_64, so they are the same on every platform.
    */
-  static U64 PIECE_KEYS[2][6][64];
+  struct Keys {
+    /**
+     * @brief Table indexed by [Color][PieceType][SquareIndex] of pseudo-random
+     * values to xor into _key for each color, piece type and square.
+     */
+    Table<Table<Table<U64, 64>, 6>, 2> pieces;
 
-  /**
-   * @brief Pseudo-random keys to xor into _key for each en passant file
-   */
-  static U64 EN_PASSANT_KEYS[8];
+    /**
+     * @brief Pseudo-random keys to xor into _key for each en passant file
+     */
+    Table<U64, 8> enPassant;
+
+    /**
+     * @name King and queenside castling keys indexed by [Color]
+     *
+     * @{
+     */
+    Table<U64, 2> ksCastle;
+    Table<U64, 2> qsCastle;
+    /**@}*/
+
+    /**
+     * @brief Key to xor into _key when it's white's turn to move.
+     */
+    U64 whiteToMove;
+  };
 
   /**
-   * @name King and queenside castling keys indexed by [Color]
-   *
-   * @{
+   * @brief Pseudo-random values used to generate a ZKey.
    */
-  static U64 KS_CASTLE_KEYS[2];
-  static U64 QS_CASTLE_KEYS[2];
-  /**@}*/
+  static const Keys KEYS;
 
   /**
-   * @brief Key to xor into _key when it's white's turn to move.
+   * @brief Seed used by the PRNG.
    */
-  static U64 WHITE_TO_MOVE_KEY;
+  static const U64 PRNG_KEY = 0xDEADBEEF;
 
   /**
-   * @brief Seed used by the PRNG.
+   * @brief Generates the pseudo-random values used to generate a ZKey.
+   *
+   * @return Pseudo-random values used to generate a ZKey
    */
-  static const unsigned int PRNG_KEY;
+  static constexpr Keys _makeKeys();
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include "defs.h"
 #include "attacks.h"
+#include "bitutils.h"
 #include "catch.hpp"
 
 TEST_CASE("AttackTable output is correct") {
@@ -20,4 +21,71 @@ TEST_CASE("AttackTable output is correct") {
     REQUIRE(Attacks::getNonSlidingAttacks(KING, 0) == 0x302);
     REQUIRE(Attacks::getNonSlidingAttacks(KING, 27) == 0x1C141C0000);
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Sliding attack lookups match slowly calculated attacks") {
+  // Exhaustively check every blocker set of every square
+#ifdef ATTACKS_MAGIC
+  SECTION("Magic rook and bishop attacks are correct for all blocker sets") {
+    for (int square = 0; square < 64; square++) {
+      U64 rookMask = Attacks::detail::_rookMasks[square];
+      for (int i = 0; i < (1 << _popCount(rookMask)); i++) {
+        U64 blockers = Attacks::detail::_getBlockersFromIndex(i, rookMask);
+        REQUIRE(Attacks::detail::_getRookAttacksMagic(square, blockers) ==
+            Attacks::detail::_getRookAttacksSlow(square, blockers));
+      }
+
+      U64 bishopMask = Attacks::detail::_bishopMasks[square];
+      for (int i = 0; i < (1 << _popCount(bishopMask)); i++) {
+        U64 blockers = Attacks::detail::_getBlockersFromIndex(i, bishopMask);
+        REQUIRE(Attacks::detail::_getBishopAttacksMagic(square, blockers) ==
+            Attacks::detail::_getBishopAttacksSlow(square, blockers));
+      }
+    }
+  }
+#endif
+
+#ifdef ATTACKS_PEXT
+  SECTION("PEXT rook and bishop attacks are correct for all blocker sets") {
+    if (Attacks::detail::_pextSupported()) {
+      for (int square = 0; square < 64; square++) {
+        U64 rookMask = Attacks::detail::_rookMasks[square];
+        for (int i = 0; i < (1 << _popCount(rookMask)); i++) {
+          U64 blockers = Attacks::detail::_getBlockersFromIndex(i, rookMask);
+          REQUIRE(Attacks::detail::_getRookAttacksPext(square, blockers) ==
+              Attacks::detail::_getRookAttacksSlow(square, blockers));
+        }
+
+        U64 bishopMask = Attacks::detail::_bishopMasks[square];
+        for (int i = 0; i < (1 << _popCount(bishopMask)); i++) {
+          U64 blockers = Attacks::detail::_getBlockersFromIndex(i, bishopMask);
+          REQUIRE(Attacks::detail::_getBishopAttacksPext(square, blockers) ==
+              Attacks::detail::_getBishopAttacksSlow(square, blockers));
+        }
+      }
+    }
+  }
+#endif
+
+  SECTION("Each square's attacks fit in its part of the packed sliding attack table") {
+    for (int square = 0; square < 64; square++) {
+      REQUIRE(Attacks::detail::_rookIndexBits[square] == _popCount(Attacks::detail::_rookMasks[square]));
+      REQUIRE(Attacks::detail::_bishopIndexBits[square] == _popCount(Attacks::detail::_bishopMasks[square]));
+    }
+    REQUIRE(Attacks::detail::_bishopOffsets[63] + (1 << Attacks::detail::_bishopIndexBits[63]) ==
+        Attacks::detail::_SLIDING_TABLE_SIZE);
+  }
+
+  SECTION("Sliding attacks ignore blockers outside of the attack masks") {
+    U64 blockers = 0x8142241818244281ULL | RANK_1 | RANK_8 | FILE_A | FILE_H;
+    for (int square = 0; square < 64; square++) {
+      REQUIRE(Attacks::getSlidingAttacks(ROOK, square, blockers) ==
+          Attacks::detail::_getRookAttacksSlow(square, blockers));
+      REQUIRE(Attacks::getSlidingAttacks(BISHOP, square, blockers) ==
+          Attacks::detail::_getBishopAttacksSlow(square, blockers));
+      REQUIRE(Attacks::getSlidingAttacks(QUEEN, square, blockers) ==
+          (Attacks::detail::_getRookAttacksSlow(square, blockers) |
+              Attacks::detail::_getBishopAttacksSlow(square, blockers)));
+    }
+  }
+}
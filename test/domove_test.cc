@@ -1,4 +1,5 @@
 #include "board.h"
+#include "movegen.h"
 #include "catch.hpp"
 #include <iostream>
 
@@ -196,3 +197,81 @@ TEST_CASE("Board::doMove works properly") {
     REQUIRE(board.getEnPassant() == (ONE << a6));
   }
 }
+
+namespace {
+void requireSameState(const Board &board, const Board &expected) {
+  REQUIRE(board.getStringRep() == expected.getStringRep());
+  REQUIRE(board.getActivePlayer() == expected.getActivePlayer());
+  REQUIRE(board.getEnPassant() == expected.getEnPassant());
+  REQUIRE(board.getHalfmoveClock() == expected.getHalfmoveClock());
+  REQUIRE(board.getZKey().getValue() == expected.getZKey().getValue());
+  REQUIRE(board.getPawnStructureZKey().getValue() == expected.getPawnStructureZKey().getValue());
+  REQUIRE(board.getMaterialZKey().getValue() == expected.getMaterialZKey().getValue());
+  REQUIRE(board.getPhaseWeight() == expected.getPhaseWeight());
+  REQUIRE(board.getOccupied() == expected.getOccupied());
+
+  for (auto color : {WHITE, BLACK}) {
+    REQUIRE(board.getAllPieces(color) == expected.getAllPieces(color));
+    REQUIRE(board.getKsCastlingRights(color) == expected.getKsCastlingRights(color));
+    REQUIRE(board.getQsCastlingRights(color) == expected.getQsCastlingRights(color));
+    REQUIRE(board.getMaterial(color) == expected.getMaterial(color));
+    for (auto pieceType : {PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING}) {
+      REQUIRE(board.getPieceCount(color, pieceType) == expected.getPieceCount(color, pieceType));
+    }
+    for (auto phase : {OPENING, ENDGAME}) {
+      REQUIRE(board.getPSquareTable().getScore(phase, color) == expected.getPSquareTable().getScore(phase, color));
+    }
+  }
+}
+
+void requireUndoRestores(Board &board, int depth) {
+  if (depth == 0) return;
+
+  Board original = board;
+  for (auto move : MoveGen(board).getLegalMoves()) {
+    UndoInfo undoInfo = board.doMove(move);
+    requireUndoRestores(board, depth - 1);
+    board.undoMove(move, undoInfo);
+
+    requireSameState(board, original);
+  }
+}
+}
+
+TEST_CASE("Board::undoMove restores the board to its state before doMove") {
+  SECTION("undoMove works from the starting position") {
+    Board board;
+    requireUndoRestores(board, 2);
+  }
+
+  SECTION("undoMove works with castling, en passant and promotions") {
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+    requireUndoRestores(board, 2);
+
+    board.setToFen("n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - -");
+    requireUndoRestores(board, 2);
+
+    board.setToFen("8/8/8/KPp4r/8/8/8/7k w - c6 0 2");
+    requireUndoRestores(board, 2);
+  }
+}
+
+TEST_CASE("Board::doNullMove passes the turn to the opponent") {
+  SECTION("doNullMove flips the active player and clears the en passant square") {
+    Board board("rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 3");
+    board.doNullMove();
+
+    Board expected("rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR w KQkq - 1 3");
+    requireSameState(board, expected);
+  }
+
+  SECTION("undoNullMove restores the board to its state before doNullMove") {
+    Board board("rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 3");
+    Board original = board;
+
+    UndoInfo undoInfo = board.doNullMove();
+    board.undoNullMove(undoInfo);
+
+    requireSameState(board, original);
+  }
+}
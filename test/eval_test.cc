@@ -56,14 +56,16 @@ TEST_CASE("Evaluation functions work properly") {
 
   SECTION("Mobility evaluations are correct") {
     board.setToStartPos();
-    REQUIRE(Eval::evaluateMobility(board, OPENING, WHITE) == Eval::evaluateMobility(board, OPENING, BLACK));
+    REQUIRE(Eval::evaluateMobility(board, WHITE) == Eval::evaluateMobility(board, BLACK));
 
     // Queen moves should carry some weight in the endgame
     board.setToFen("7k/8/8/8/4q3/8/8/K7 w - -");
-    REQUIRE(Eval::evaluateMobility(board, ENDGAME, WHITE) < Eval::evaluateMobility(board, ENDGAME, BLACK));
+    REQUIRE(getEndgameScore(Eval::evaluateMobility(board, WHITE))
+                < getEndgameScore(Eval::evaluateMobility(board, BLACK)));
 
     board.setToFen("7k/8/8/3Rr3/8/8/8/K7 w - -");
-    REQUIRE(Eval::evaluateMobility(board, OPENING, WHITE) == Eval::evaluateMobility(board, OPENING, BLACK));
+    REQUIRE(getOpeningScore(Eval::evaluateMobility(board, WHITE))
+                == getOpeningScore(Eval::evaluateMobility(board, BLACK)));
   }
 
   SECTION("Bishop pair calculations are correct") {
@@ -151,6 +153,27 @@ TEST_CASE("Evaluation functions work properly") {
     REQUIRE(Eval::passedPawns(board, BLACK) == 1);
   }
 
+  SECTION("Pawn structure table entries are correct") {
+    PawnStructureTable pawnTable(16);
+    board.setToFen("4k3/1p2p3/1p6/8/7P/2P4P/8/4K3 w KQkq -");
+
+    const PawnStructureTable::Entry &entry = pawnTable.probe(board);
+    REQUIRE(entry.key == board.getPawnStructureZKey().getValue());
+    REQUIRE(entry.passedPawns[WHITE] == ((ONE << h3) | (ONE << h4)));
+    REQUIRE(entry.passedPawns[BLACK] == (ONE << e7));
+    REQUIRE(entry.files[WHITE] == ((1 << 2) | (1 << 7)));
+    REQUIRE(entry.files[BLACK] == ((1 << 1) | (1 << 4)));
+    REQUIRE(entry.attackSpans[WHITE] == ((FILE_B | FILE_D | FILE_G) & ~(RANK_1 | RANK_2 | RANK_3)));
+
+    // Probing again returns the same entry
+    REQUIRE(&pawnTable.probe(board) == &entry);
+
+    // Evaluating with and without a table gives the same score
+    board.setToFen("rnbqkb2/pp3ppp/4pn2/3p2B1/3PP3/2N5/PPP2PPP/R2QKB1R b KQkq -");
+    REQUIRE(Eval::evaluate(board, WHITE, &pawnTable) == Eval::evaluate(board, WHITE));
+    REQUIRE(Eval::evaluate(board, BLACK, &pawnTable) == Eval::evaluate(board, BLACK));
+  }
+
   SECTION("Phase calculations are correct") {
     board.setToStartPos();
     REQUIRE(Eval::getPhase(board) == 0);
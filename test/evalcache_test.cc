@@ -0,0 +1,74 @@
+#include "catch.hpp"
+#include "evalcache.h"
+#include "board.h"
+
+TEST_CASE("Evaluation caches work as expected") {
+  Board board;
+  EvalCache evalCache;
+
+  board.setToStartPos();
+  ZKey key1 = board.getZKey();
+
+  board.setToFen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq -");
+  ZKey key2 = board.getZKey();
+
+  SECTION("Evaluation caches store multiple board keys separately") {
+    evalCache.store(key1, 25);
+    evalCache.store(key2, -1200);
+
+    int score;
+    REQUIRE(evalCache.probe(key1, score));
+    REQUIRE(score == 25);
+
+    REQUIRE(evalCache.probe(key2, score));
+    REQUIRE(score == -1200);
+  }
+
+  SECTION("Evaluation caches miss on keys that haven't been stored") {
+    evalCache.store(key1, 25);
+
+    int score;
+    REQUIRE(!evalCache.probe(key2, score));
+  }
+
+  SECTION("Scores that don't fit in 16 bits are not stored") {
+    evalCache.store(key1, 40000);
+
+    int score;
+    REQUIRE(!evalCache.probe(key1, score));
+  }
+
+  SECTION("Evaluation caches count probes and hits") {
+    evalCache.store(key1, 25);
+
+    int score;
+    evalCache.probe(key1, score);
+    evalCache.probe(key2, score);
+    evalCache.probe(key1, score);
+
+    REQUIRE(evalCache.getProbes() == 3);
+    REQUIRE(evalCache.getHits() == 2);
+
+    evalCache.resetStats();
+    REQUIRE(evalCache.getProbes() == 0);
+    REQUIRE(evalCache.getHits() == 0);
+    REQUIRE(evalCache.probe(key1, score));
+  }
+
+  SECTION("Clearing an evaluation cache removes all evaluations") {
+    evalCache.store(key1, 25);
+    evalCache.clear();
+
+    int score;
+    REQUIRE(!evalCache.probe(key1, score));
+  }
+
+  SECTION("Evaluation caches with out of range sizes use the closest valid size") {
+    EvalCache tooSmall(-1);
+    tooSmall.store(key1, 25);
+
+    int score;
+    REQUIRE(tooSmall.probe(key1, score));
+    REQUIRE(score == 25);
+  }
+}
@@ -1,5 +1,6 @@
 #include "catch.hpp"
 #include "generalmovepicker.h"
+#include <algorithm>
 
 TEST_CASE("GeneralMovePicker works as expected") {
   Board board;
@@ -9,8 +10,7 @@ TEST_CASE("GeneralMovePicker works as expected") {
   SECTION("GeneralMovePicker returns the hash move first") {
     board.setToFen("7k/8/8/8/4p3/8/5N2/K7 w - -");
 
-    MoveGen moveGen(board);
-    MoveList moves = moveGen.getLegalMoves();
+    MoveList moves;
 
     // Set NxP as the has move
     Move hashMove(f2, e4, KNIGHT, Move::CAPTURE);
@@ -26,8 +26,7 @@ TEST_CASE("GeneralMovePicker works as expected") {
   SECTION("GeneralMovePicker returns captures after the hash move in MVV/LVA order") {
     board.setToFen("7k/1R6/1p6/8/4r3/8/5N2/K2b4 w - -");
 
-    MoveGen movegen(board);
-    MoveList moves = movegen.getLegalMoves();
+    MoveList moves;
     GeneralMovePicker movePicker(const_cast<OrderingInfo *>(&orderingInfo), const_cast<Board *>(&board), &moves);
 
     // f2 x e4
@@ -52,8 +51,7 @@ TEST_CASE("GeneralMovePicker works as expected") {
   SECTION("GeneralMovePicker returns promotions after captures sorted by promotion value") {
     board.setToFen("7k/2P5/8/8/8/8/8/K7 w - -");
 
-    MoveGen movegen(board);
-    MoveList moves = movegen.getLegalMoves();
+    MoveList moves;
     GeneralMovePicker movePicker(const_cast<OrderingInfo *>(&orderingInfo), const_cast<Board *>(&board), &moves);
 
     // Queen promotion
@@ -84,8 +82,7 @@ TEST_CASE("GeneralMovePicker works as expected") {
   SECTION("GeneralMovePicker returns killer 1 and 2 (in that order) after promotions") {
     board.setToStartPos();
 
-    MoveGen movegen(board);
-    MoveList moves = movegen.getLegalMoves();
+    MoveList moves;
 
     Move killer1(e2, e4, PAWN, Move::DOUBLE_PAWN_PUSH);
     Move killer2(f2, f4, PAWN, Move::DOUBLE_PAWN_PUSH);
@@ -105,8 +102,7 @@ TEST_CASE("GeneralMovePicker works as expected") {
   SECTION("GeneralMovePicker returns quiets last sorted by history") {
     board.setToFen("7k/8/8/8/2P5/8/8/K6N w - -");
 
-    MoveGen moveGen(board);
-    MoveList moves = moveGen.getLegalMoves();
+    MoveList moves;
 
     // History values h1g3 < h1f2 < c4c5
     orderingInfo.incrementHistory(WHITE, c4, c5, 3);
@@ -124,4 +120,51 @@ TEST_CASE("GeneralMovePicker works as expected") {
     REQUIRE(movePicker.hasNext());
     REQUIRE(movePicker.getNext() == Move(h1, g3, KNIGHT));
   }
-}
\ No newline at end of file
+
+  SECTION("GeneralMovePicker returns every legal move exactly once, ignoring illegal hash and killer moves") {
+    board.setToFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+
+    // Illegal hash and killer moves (no piece on the from square / blocked)
+    tt.set(board.getZKey(), TranspTableEntry(0, 1, TranspTableEntry::EXACT, Move(a3, a4, PAWN)));
+    orderingInfo.updateKillers(0, Move(a1, a3, ROOK));
+    orderingInfo.updateKillers(0, Move(e2, a6, BISHOP));
+
+    MoveList moves;
+    GeneralMovePicker movePicker(&orderingInfo, &board, &moves);
+
+    MoveList legalMoves = MoveGen(board).getLegalMoves();
+    MoveList pickedMoves;
+    while (movePicker.hasNext()) {
+      Move move = movePicker.getNext();
+      REQUIRE(std::find(pickedMoves.begin(), pickedMoves.end(), move) == pickedMoves.end());
+      REQUIRE(std::find(legalMoves.begin(), legalMoves.end(), move) != legalMoves.end());
+      pickedMoves.push_back(move);
+    }
+
+    REQUIRE(pickedMoves.size() == legalMoves.size());
+  }
+
+  SECTION("GeneralMovePicker only reports quiet moves picked after killers as picked quiets") {
+    board.setToFen("7k/8/8/8/4p3/8/2P2N2/K7 w - -");
+
+    Move killer(c2, c3, PAWN);
+    orderingInfo.updateKillers(0, killer);
+
+    MoveList moves;
+    GeneralMovePicker movePicker(&orderingInfo, &board, &moves);
+
+    // f2 x e4
+    REQUIRE(movePicker.hasNext());
+    REQUIRE(movePicker.getNext().getTo() == e4);
+    REQUIRE_FALSE(movePicker.pickedQuiet());
+
+    REQUIRE(movePicker.hasNext());
+    REQUIRE(movePicker.getNext() == killer);
+    REQUIRE_FALSE(movePicker.pickedQuiet());
+
+    while (movePicker.hasNext()) {
+      movePicker.getNext();
+      REQUIRE(movePicker.pickedQuiet());
+    }
+  }
+}
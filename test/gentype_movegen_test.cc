@@ -0,0 +1,78 @@
+#include "catch.hpp"
+#include "movegen.h"
+#include <algorithm>
+
+namespace {
+bool contains(const MoveList &moves, Move move) {
+  return std::find(moves.begin(), moves.end(), move) != moves.end();
+}
+
+void requireGenTypesPartitionLegalMoves(Board &board, int depth) {
+  MoveList all, captures, quiets;
+  MoveGen::genLegalMoves(board, all);
+  MoveGen::genLegalMoves(board, captures, MoveGen::CAPTURES);
+  MoveGen::genLegalMoves(board, quiets, MoveGen::QUIETS);
+
+  REQUIRE(captures.size() + quiets.size() == all.size());
+  REQUIRE(MoveGen::hasLegalMoves(board) == !all.empty());
+  for (auto move : captures) {
+    REQUIRE(contains(all, move));
+    REQUIRE((move.getFlags() & (Move::CAPTURE | Move::EN_PASSANT | Move::PROMOTION)) != 0);
+  }
+  for (auto move : quiets) {
+    REQUIRE(contains(all, move));
+  }
+
+  if (board.colorIsInCheck(board.getActivePlayer())) {
+    MoveList evasions;
+    MoveGen::genLegalMoves(board, evasions, MoveGen::EVASIONS);
+    REQUIRE(evasions.size() == all.size());
+  }
+
+  if (depth == 0) return;
+
+  for (auto move : all) {
+    UndoInfo undoInfo = board.doMove(move);
+    requireGenTypesPartitionLegalMoves(board, depth - 1);
+    board.undoMove(move, undoInfo);
+  }
+}
+}
+
+TEST_CASE("Legal moves can be generated by type") {
+  SECTION("Captures and quiet moves partition all legal moves") {
+    Board board("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+    requireGenTypesPartitionLegalMoves(board, 2);
+
+    board.setToFen("n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - -");
+    requireGenTypesPartitionLegalMoves(board, 2);
+  }
+
+  SECTION("Checkmate and stalemate positions have no legal moves") {
+    REQUIRE(!MoveGen::hasLegalMoves(Board("7k/5Q2/6K1/8/8/8/8/8 b - -")));
+    REQUIRE(!MoveGen::hasLegalMoves(Board("rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq -")));
+
+    // The king is not in check and still has squares to move to
+    REQUIRE(MoveGen::hasLegalMoves(Board("7k/8/8/8/8/8/5Q2/7K b - -")));
+  }
+
+  SECTION("Evasions only contain moves out of check") {
+    // Double check, only king moves are possible
+    Board board("4k3/8/8/8/8/8/3n4/4RK1r w - -");
+    MoveList evasions;
+    MoveGen::genLegalMoves(board, evasions, MoveGen::EVASIONS);
+
+    REQUIRE(evasions.size() == 3);
+    for (auto move : evasions) {
+      REQUIRE(move.getPieceType() == KING);
+    }
+
+    // Single check, block with the rook, capture the checker or move the king
+    board.setToFen("4k3/8/8/8/8/8/1R6/r3K3 w - -");
+    evasions.clear();
+    MoveGen::genLegalMoves(board, evasions, MoveGen::EVASIONS);
+
+    REQUIRE(evasions.size() == 4);
+    REQUIRE(contains(evasions, Move(b2, b1, ROOK)));
+  }
+}
@@ -153,6 +153,7 @@ TEST_CASE("King move generation is correct") {
 
     REQUIRE(board.whiteCanCastleKs() == true);
     Move move(d5, h1, BISHOP, Move::CAPTURE);
+    move.setCapturedPieceType(ROOK);
 
     board.doMove(move);
 
@@ -164,6 +165,7 @@ TEST_CASE("King move generation is correct") {
 
     REQUIRE(board.whiteCanCastleQs() == true);
     Move move(e4, a1, BISHOP, Move::CAPTURE);
+    move.setCapturedPieceType(ROOK);
 
     board.doMove(move);
 
@@ -175,6 +177,7 @@ TEST_CASE("King move generation is correct") {
 
     REQUIRE(board.blackCanCastleKs() == true);
     Move move(e5, h8, BISHOP, Move::CAPTURE);
+    move.setCapturedPieceType(ROOK);
 
     board.doMove(move);
 
@@ -186,6 +189,7 @@ TEST_CASE("King move generation is correct") {
 
     REQUIRE(board.blackCanCastleQs() == true);
     Move move(e4, a8, BISHOP, Move::CAPTURE);
+    move.setCapturedPieceType(ROOK);
 
     board.doMove(move);
 
@@ -0,0 +1,45 @@
+#include "movelist.h"
+#include "catch.hpp"
+
+TEST_CASE("MoveLists work as expected") {
+  MoveList moves;
+
+  SECTION("MoveLists are empty when constructed") {
+    REQUIRE(moves.empty());
+    REQUIRE(moves.size() == 0);
+    REQUIRE(moves.begin() == moves.end());
+  }
+
+  SECTION("MoveLists store moves in the order they are added") {
+    Move move1(e2, e4, PAWN, Move::DOUBLE_PAWN_PUSH);
+    Move move2(g1, f3, KNIGHT);
+
+    moves.push_back(move1);
+    moves.push_back(move2);
+
+    REQUIRE(moves.size() == 2);
+    REQUIRE(moves.at(0) == move1);
+    REQUIRE(moves[1] == move2);
+
+    int count = 0;
+    for (auto move : moves) {
+      REQUIRE(move == moves.at(count++));
+    }
+    REQUIRE(count == 2);
+
+    moves.clear();
+    REQUIRE(moves.empty());
+  }
+
+  SECTION("MoveLists can hold MoveList::MAX_SIZE moves and be copied") {
+    for (int i = 0; i < MoveList::MAX_SIZE; i++) {
+      moves.push_back(Move(i % 64, (i + 1) % 64, QUEEN));
+    }
+
+    MoveList copy = moves;
+    REQUIRE(copy.size() == static_cast<size_t>(MoveList::MAX_SIZE));
+    for (int i = 0; i < MoveList::MAX_SIZE; i++) {
+      REQUIRE(copy.at(i) == moves.at(i));
+    }
+  }
+}
@@ -0,0 +1,156 @@
+#include "nnue.h"
+#include "board.h"
+#include "movegen.h"
+#include "catch.hpp"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+namespace {
+template<typename T>
+void writeValue(std::ostream &stream, const T &value) {
+  stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+std::string makeNetworkFile(unsigned int seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> weights(-64, 64);
+
+  std::unique_ptr<Nnue::Network> network(new Nnue::Network());
+  for (auto &input : network->featureWeights) {
+    for (auto &weight : input) weight = static_cast<int16_t>(weights(rng));
+  }
+  for (auto &bias : network->featureBiases) bias = static_cast<int16_t>(weights(rng) * 2);
+  for (auto &perspective : network->outputWeights) {
+    for (auto &weight : perspective) weight = static_cast<int16_t>(weights(rng));
+  }
+  network->outputBias = 1000;
+
+  std::ostringstream stream;
+  stream.write("SBNN", 4);
+  writeValue(stream, Nnue::FILE_VERSION);
+  writeValue(stream, static_cast<uint32_t>(Nnue::INPUT_SIZE));
+  writeValue(stream, static_cast<uint32_t>(Nnue::HIDDEN_SIZE));
+  writeValue(stream, network->featureWeights);
+  writeValue(stream, network->featureBiases);
+  writeValue(stream, network->outputWeights);
+  writeValue(stream, network->outputBias);
+  return stream.str();
+}
+
+bool sameAccumulator(const Nnue::Accumulator &a, const Nnue::Accumulator &b) {
+  return std::memcmp(a.values, b.values, sizeof(a.values)) == 0;
+}
+
+void requireIncrementalMatchesRefresh(Board &board, std::shared_ptr<const Nnue::Network> network, int depth) {
+  if (depth == 0) return;
+
+  for (auto move : MoveGen(board).getLegalMoves()) {
+    Nnue::Accumulator before = board.getAccumulators()->top();
+
+    UndoInfo undoInfo = board.doMove(move);
+
+    Board copy = board;
+    Nnue::AccumulatorStack expected(network);
+    copy.setAccumulators(&expected);
+    REQUIRE(sameAccumulator(board.getAccumulators()->top(), expected.top()));
+
+    requireIncrementalMatchesRefresh(board, network, depth - 1);
+    board.undoMove(move, undoInfo);
+
+    REQUIRE(sameAccumulator(board.getAccumulators()->top(), before));
+  }
+}
+
+int referenceEvaluate(const Nnue::Network &network, const Board &board) {
+  int32_t hidden[2][Nnue::HIDDEN_SIZE];
+  for (auto perspective : {WHITE, BLACK}) {
+    std::copy(network.featureBiases, network.featureBiases + Nnue::HIDDEN_SIZE, hidden[perspective]);
+  }
+
+  for (int square = 0; square < 64; square++) {
+    for (auto color : {WHITE, BLACK}) {
+      for (auto pieceType : {PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING}) {
+        if (!(board.getPieces(color, pieceType) & (ONE << square))) continue;
+
+        int whiteInput = color * 384 + pieceType * 64 + square;
+        int blackInput = getOppositeColor(color) * 384 + pieceType * 64 + (square ^ 56);
+        for (int i = 0; i < Nnue::HIDDEN_SIZE; i++) {
+          hidden[WHITE][i] += network.featureWeights[whiteInput][i];
+          hidden[BLACK][i] += network.featureWeights[blackInput][i];
+        }
+      }
+    }
+  }
+
+  int32_t output = network.outputBias;
+  Color us = board.getActivePlayer();
+  for (int i = 0; i < Nnue::HIDDEN_SIZE; i++) {
+    output += std::min(std::max(hidden[us][i], 0), Nnue::QA) * network.outputWeights[0][i];
+    output += std::min(std::max(hidden[getOppositeColor(us)][i], 0), Nnue::QA) * network.outputWeights[1][i];
+  }
+  return static_cast<int>(static_cast<int64_t>(output) * Nnue::OUTPUT_SCALE / (Nnue::QA * Nnue::QB));
+}
+}
+
+TEST_CASE("NNUE evaluation works as expected") {
+  std::istringstream networkFile(makeNetworkFile(1));
+  std::shared_ptr<const Nnue::Network> network = Nnue::read(networkFile);
+  REQUIRE(network != nullptr);
+
+  Nnue::AccumulatorStack accumulators(network);
+  Board board;
+
+  SECTION("Invalid network files are rejected") {
+    std::string file = makeNetworkFile(1);
+
+    std::istringstream truncated(file.substr(0, file.size() - 1));
+    REQUIRE(Nnue::read(truncated) == nullptr);
+
+    std::string wrongMagic = file;
+    wrongMagic[0] = 'X';
+    std::istringstream wrongMagicStream(wrongMagic);
+    REQUIRE(Nnue::read(wrongMagicStream) == nullptr);
+  }
+
+  SECTION("Accumulators are updated correctly by moves and restored by undoing them") {
+    for (auto fen : {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -",
+                     "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq -",
+                     "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -"}) {
+      board.setToFen(fen);
+      board.setAccumulators(&accumulators);
+      requireIncrementalMatchesRefresh(board, network, 2);
+    }
+  }
+
+  SECTION("Evaluation matches a straightforward calculation") {
+    for (auto fen : {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq -",
+                     "rnbqkb2/pp3ppp/4pn2/3p2B1/3PP3/2N5/PPP2PPP/R2QKB1R b KQkq -",
+                     "6k1/6p1/8/6KQ/1r6/q2b4/8/8 w - -"}) {
+      board.setToFen(fen);
+      board.setAccumulators(&accumulators);
+      REQUIRE(Nnue::evaluate(board) == referenceEvaluate(*network, board));
+    }
+  }
+
+  SECTION("Mirrored positions have the same evaluation") {
+    board.setToFen("rnbqkb2/pp3ppp/4pn2/3p2B1/3PP3/2N5/PPP2PPP/R2QKB1R b KQkq -");
+    board.setAccumulators(&accumulators);
+    int score = Nnue::evaluate(board);
+
+    Nnue::AccumulatorStack mirroredAccumulators(network);
+    Board mirrored("r2qkb1r/ppp2ppp/2n5/3pp3/3P2b1/4PN2/PP3PPP/RNBQKB2 w KQkq -");
+    mirrored.setAccumulators(&mirroredAccumulators);
+    REQUIRE(Nnue::evaluate(mirrored) == score);
+  }
+
+  SECTION("Copies of a board don't inherit its accumulators") {
+    board.setToStartPos();
+    board.setAccumulators(&accumulators);
+
+    Board copy = board;
+    REQUIRE(copy.getAccumulators() == nullptr);
+    REQUIRE(board.getAccumulators() == &accumulators);
+  }
+}
@@ -36,10 +36,12 @@ TEST_CASE("OrderingInfo class works correctly") {
 
     OrderingInfo orderingInfo(ttPointer);
 
-    REQUIRE(orderingInfo.getTt()->getEntry(zkey)->getScore() == 1);
-    REQUIRE(orderingInfo.getTt()->getEntry(zkey)->getDepth() == 2);
-    REQUIRE(orderingInfo.getTt()->getEntry(zkey)->getFlag() == TranspTable::UPPER_BOUND);
-    REQUIRE(orderingInfo.getTt()->getEntry(zkey)->getBestMove() == bestMove);
+    TranspTableEntry storedEntry;
+    REQUIRE(orderingInfo.getTt()->probe(zkey, storedEntry));
+    REQUIRE(storedEntry.getScore() == 1);
+    REQUIRE(storedEntry.getDepth() == 2);
+    REQUIRE(storedEntry.getFlag() == TranspTable::UPPER_BOUND);
+    REQUIRE(storedEntry.getBestMove() == bestMove);
   }
 
   SECTION("OrderingInfo stores killer moves correctly") {
@@ -87,5 +89,25 @@ TEST_CASE("OrderingInfo class works correctly") {
 
     REQUIRE(shallowHistory > deepHistory);
   }
-}
+  SECTION("OrderingInfo only returns principal variation moves on the principal variation") {
+    OrderingInfo orderingInfo(emptyTtPointer);
+    Board board;
+
+    MoveList pv;
+    pv.push_back(Move(e2, e4, PAWN, Move::DOUBLE_PAWN_PUSH));
+    pv.push_back(Move(e7, e5, PAWN, Move::DOUBLE_PAWN_PUSH));
+    orderingInfo.setPv(board, pv);
+
+    REQUIRE(orderingInfo.getPvMove(0, board) == pv[0]);
 
+    board.doMove(pv[0]);
+    REQUIRE(orderingInfo.getPvMove(1, board) == pv[1]);
+
+    // Positions off the principal variation and plys past its end have no move
+    Board otherBoard("rnbqkbnr/pppppppp/8/8/3P4/8/PPP1PPPP/RNBQKBNR b KQkq d3");
+    REQUIRE(orderingInfo.getPvMove(1, otherBoard) == Move());
+
+    board.doMove(pv[1]);
+    REQUIRE(orderingInfo.getPvMove(2, board) == Move());
+  }
+}
@@ -1,25 +1,10 @@
 #include "board.h"
 #include "movegen.h"
+#include "perft.h"
 #include "catch.hpp"
 
-unsigned long long perft(int depth, const Board& board) {
-  if (depth == 0) {
-    return 1;
-  } else if (depth == 1) {
-    return MoveGen(board).getLegalMoves().size();
-  }
-
-  MoveGen movegen(board);
-
-  unsigned long long nodes = 0;
-  for (auto move : movegen.getLegalMoves()) {
-    Board movedBoard = board;
-    movedBoard.doMove(move);
-
-    nodes += perft(depth - 1, movedBoard);
-  }
-
-  return nodes;
+unsigned long long perft(int depth, Board& board) {
+  return Perft().perft(board, depth);
 }
 
 TEST_CASE("Perft is correct", "[perft]") {
@@ -122,4 +107,43 @@ TEST_CASE("Perft is correct", "[perft]") {
     REQUIRE(perft(3, board) == 388081);
     REQUIRE(perft(4, board) == 27735148);
   }
+
+  SECTION("Perft is correct for en passant captures that expose or check a king") {
+    board.setToFen("3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1");
+    REQUIRE(perft(6, board) == 1134888);
+
+    board.setToFen("8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1");
+    REQUIRE(perft(6, board) == 1015133);
+
+    board.setToFen("8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1");
+    REQUIRE(perft(6, board) == 1440467);
+  }
+
+  SECTION("Perft is correct when using multiple threads and a perft hash table") {
+    Perft hashedPerft(4, 16);
+
+    board.setToStartPos();
+    REQUIRE(hashedPerft.perft(board, 6) == 119060324);
+
+    board.setToFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -");
+    REQUIRE(hashedPerft.perft(board, 5) == 193690690);
+
+    board.setToFen("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -");
+    REQUIRE(hashedPerft.perft(board, 6) == 11030083);
+    REQUIRE(hashedPerft.perft(board, 7) == 178633661);
+  }
+
+  SECTION("Perft divide node counts add up to the perft of each root move") {
+    board.setToFen("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+
+    unsigned long long total = 0;
+    for (auto rootCount : Perft(2, 1).divide(board, 4)) {
+      Board child = board;
+      child.doMove(rootCount.first);
+
+      REQUIRE(rootCount.second == perft(3, child));
+      total += rootCount.second;
+    }
+    REQUIRE(total == 422333);
+  }
 }
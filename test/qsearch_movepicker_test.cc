@@ -5,10 +5,10 @@
 TEST_CASE("QSearchMovePicker works as expected") {
   Board board;
 
-  SECTION("QSearchMovePicker does not return non captures") {
+  SECTION("QSearchMovePicker does not return non captures when given captures") {
     board.setToFen("7k/8/5r2/2p5/8/P1R2n2/8/Kb6 w - -");
-    MoveGen moveGen(board);
-    MoveList moves = moveGen.getLegalMoves();
+    MoveList moves;
+    MoveGen::genLegalMoves(board, moves, MoveGen::CAPTURES);
 
     QSearchMovePicker movePicker(&moves);
 
@@ -24,8 +24,8 @@ TEST_CASE("QSearchMovePicker works as expected") {
 
   SECTION("QSearchMovePicker returns captures sorted by MVV/LVA") {
     board.setToFen("7k/1p5B/4b3/8/3N4/1R3q2/6P1/K7 w - -");
-    MoveGen moveGen(board);
-    MoveList moves = moveGen.getLegalMoves();
+    MoveList moves;
+    MoveGen::genLegalMoves(board, moves, MoveGen::CAPTURES);
 
     QSearchMovePicker movePicker(&moves);
 
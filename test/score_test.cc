@@ -0,0 +1,24 @@
+#include "score.h"
+#include "catch.hpp"
+
+TEST_CASE("Packed scores work as expected") {
+  SECTION("Scores unpack to the values they were made from") {
+    for (int opening : {0, 1, -1, 900, -900, 32767, -32768}) {
+      for (int endgame : {0, 1, -1, 140, -140, 32767, -32768}) {
+        Score score = makeScore(opening, endgame);
+        REQUIRE(getOpeningScore(score) == opening);
+        REQUIRE(getEndgameScore(score) == endgame);
+      }
+    }
+  }
+
+  SECTION("Arithmetic on scores applies to both halves") {
+    Score a = makeScore(100, -30);
+    Score b = makeScore(-250, 70);
+
+    REQUIRE(a + b == makeScore(-150, 40));
+    REQUIRE(a - b == makeScore(350, -100));
+    REQUIRE(-a == makeScore(-100, 30));
+    REQUIRE(b * -3 == makeScore(750, -210));
+  }
+}
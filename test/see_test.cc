@@ -0,0 +1,63 @@
+#include "board.h"
+#include "movepicker.h"
+#include "catch.hpp"
+
+namespace {
+Move capture(int from, int to, PieceType pieceType, PieceType capturedPieceType) {
+  Move move(from, to, pieceType, Move::CAPTURE);
+  move.setCapturedPieceType(capturedPieceType);
+  return move;
+}
+}
+
+TEST_CASE("Board::see evaluates exchanges correctly") {
+  Board board;
+
+  SECTION("Capturing an undefended piece wins the piece") {
+    board.setToFen("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - -");
+
+    REQUIRE(board.see(capture(e1, e5, ROOK, PAWN)) == 100);
+  }
+
+  SECTION("Capturing a defended pawn with a knight loses material") {
+    board.setToFen("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - -");
+
+    REQUIRE(board.see(capture(d3, e5, KNIGHT, PAWN)) == 100 - 320);
+  }
+
+  SECTION("Sliders behind other attackers join the exchange (x-rays)") {
+    // Rxd5 Rxd5 Rxd5: white wins a pawn thanks to the doubled rooks
+    board.setToFen("3r2k1/8/8/3p4/8/8/3R4/3R2K1 w - -");
+    REQUIRE(board.see(capture(d2, d5, ROOK, PAWN)) == 100);
+
+    // With a black queen behind the black rook, the exchange loses a rook for a pawn
+    board.setToFen("3q2k1/3r4/8/3p4/8/8/3R4/3R2K1 w - -");
+    REQUIRE(board.see(capture(d2, d5, ROOK, PAWN)) == 100 - 500);
+  }
+
+  SECTION("The defending side stops capturing when recapturing would lose material") {
+    // Qxd5 Qxd5 is bad for black, as white recaptures with the rook
+    board.setToFen("6k1/8/8/3r4/8/3Q4/8/3R2K1 b - -");
+    REQUIRE(board.see(capture(d5, d3, ROOK, QUEEN)) == 900 - 500);
+  }
+
+  SECTION("Kings can't capture onto defended squares") {
+    board.setToFen("6k1/8/8/8/8/2b5/3p4/4K3 w - -");
+
+    REQUIRE(board.see(capture(e1, d2, KING, PAWN)) < 0);
+  }
+
+  SECTION("En passant captures are evaluated") {
+    board.setToFen("4k3/8/8/3pP3/8/8/8/4K3 w - d6");
+
+    REQUIRE(board.see(Move(e5, d6, PAWN, Move::EN_PASSANT)) == 100);
+  }
+
+  SECTION("isLosingCapture only reports captures with a negative SEE") {
+    board.setToFen("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - -");
+    REQUIRE(MovePicker::isLosingCapture(board, capture(d3, e5, KNIGHT, PAWN)));
+
+    board.setToFen("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - -");
+    REQUIRE_FALSE(MovePicker::isLosingCapture(board, capture(e1, e5, ROOK, PAWN)));
+  }
+}
@@ -2,17 +2,11 @@
 #include "catch.hpp"
 #include "uci.h"
 #include "attacks.h"
-#include "movepicker.h"
-#include "eval.h"
-#include "rays.h"
+#include "search.h"
 
 int main(int argc, char *argv[]) {
-  Rays::init();
-  PSquareTable::init();
-  ZKey::init();
-  MovePicker::init();
   Attacks::init();
-  Eval::init();
+  Search::initLmrTable();
   Uci::init();
 
   int result = Catch::Session().run(argc, argv);
@@ -1,6 +1,9 @@
 #include "catch.hpp"
 #include "transptable.h"
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 TEST_CASE("Transposition tables work as expected") {
   Board board;
@@ -22,24 +25,119 @@ TEST_CASE("Transposition tables work as expected") {
     tt.set(key1, ttEntry1);
     tt.set(key2, ttEntry2);
 
-    const TranspTableEntry *storedEntry1 = tt.getEntry(key1);
-    REQUIRE(storedEntry1 != nullptr);
-    REQUIRE(storedEntry1->getScore() == 1);
-    REQUIRE(storedEntry1->getDepth() == 2);
-    REQUIRE(storedEntry1->getFlag() == TranspTable::EXACT);
-    REQUIRE(storedEntry1->getBestMove() == move1);
-
-    const TranspTableEntry *storedEntry2 = tt.getEntry(key2);
-    REQUIRE(storedEntry1 != nullptr);
-    REQUIRE(storedEntry2->getScore() == 3);
-    REQUIRE(storedEntry2->getDepth() == 4);
-    REQUIRE(storedEntry2->getFlag() == TranspTable::UPPER_BOUND);
-    REQUIRE(storedEntry2->getBestMove() == move2);
+    TranspTableEntry storedEntry1;
+    REQUIRE(tt.probe(key1, storedEntry1));
+    REQUIRE(storedEntry1.getScore() == 1);
+    REQUIRE(storedEntry1.getDepth() == 2);
+    REQUIRE(storedEntry1.getFlag() == TranspTable::EXACT);
+    REQUIRE(storedEntry1.getBestMove() == move1);
+
+    TranspTableEntry storedEntry2;
+    REQUIRE(tt.probe(key2, storedEntry2));
+    REQUIRE(storedEntry2.getScore() == 3);
+    REQUIRE(storedEntry2.getDepth() == 4);
+    REQUIRE(storedEntry2.getFlag() == TranspTable::UPPER_BOUND);
+    REQUIRE(storedEntry2.getBestMove() == move2);
   }
 
-  SECTION("Transposition tables return nullptr when getEntry is called for a key that does not exist") {
+  SECTION("Transposition tables return false when probe is called for a key that does not exist") {
     ZKey key; // Not stored
-    REQUIRE(tt.getEntry(key) == nullptr);
+    TranspTableEntry entry;
+    REQUIRE(!tt.probe(key, entry));
+  }
+
+  SECTION("Transposition tables preserve mate scores and overwrite entries with the same key") {
+    board.setToStartPos();
+    Move move(e2, e4, PAWN, Move::DOUBLE_PAWN_PUSH);
+
+    tt.set(board.getZKey(), TranspTableEntry(INF, 3, TranspTableEntry::LOWER_BOUND, move));
+    TranspTableEntry entry;
+    REQUIRE(tt.probe(board.getZKey(), entry));
+    REQUIRE(entry.getScore() == INF);
+
+    tt.set(board.getZKey(), TranspTableEntry(-INF, 5, TranspTableEntry::UPPER_BOUND, move));
+    REQUIRE(tt.probe(board.getZKey(), entry));
+    REQUIRE(entry.getScore() == -INF);
+    REQUIRE(entry.getDepth() == 5);
+  }
+
+  SECTION("Transposition tables keep a bounded number of entries and replace old, then shallow entries first") {
+    TranspTable smallTt(1);
+    Move move(a1, a2, PAWN);
+
+    // Store many more positions than fit in the table
+    Board deepBoard("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq -");
+    smallTt.set(deepBoard.getZKey(), TranspTableEntry(0, 100, TranspTableEntry::EXACT, move));
+
+    U64 seed = 1;
+    for (int i = 0; i < 1000000; i++) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      ZKey key;
+      key.flipPiece(static_cast<Color>(seed >> 63), PAWN, (seed >> 32) % 64);
+      key.flipPiece(WHITE, KNIGHT, (seed >> 40) % 64);
+      key.flipPiece(BLACK, BISHOP, (seed >> 48) % 64);
+      smallTt.set(key, TranspTableEntry(0, 1, TranspTableEntry::EXACT, move));
+    }
+
+    TranspTableEntry entry;
+    REQUIRE(smallTt.probe(deepBoard.getZKey(), entry));
+    REQUIRE(entry.getDepth() == 100);
+
+    // Entries from previous searches are replaced before current ones, regardless of depth
+    smallTt.newSearch();
+    for (int i = 0; i < 1000000; i++) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      ZKey key;
+      key.flipPiece(static_cast<Color>(seed >> 63), PAWN, (seed >> 32) % 64);
+      key.flipPiece(WHITE, KNIGHT, (seed >> 40) % 64);
+      key.flipPiece(BLACK, BISHOP, (seed >> 48) % 64);
+      smallTt.set(key, TranspTableEntry(0, 1, TranspTableEntry::EXACT, move));
+    }
+
+    REQUIRE(!smallTt.probe(deepBoard.getZKey(), entry));
+  }
+
+  SECTION("Transposition tables never return torn entries when used by many threads at once") {
+    TranspTable sharedTt(1);
+    std::atomic<int> numHits(0);
+    std::atomic<int> numCorrupt(0);
+
+    // Every entry's contents are derived from its key, so an entry mixing
+    // the writes of two threads can be detected
+    auto worker = [&](int threadId) {
+      U64 seed = threadId % 2;
+      for (int i = 0; i < 200000; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        ZKey key;
+        key.flipPiece(WHITE, PAWN, (seed >> 32) % 64);
+        key.flipPiece(BLACK, KNIGHT, (seed >> 40) % 64);
+        key.flipPiece(WHITE, QUEEN, (seed >> 48) % 64);
+
+        int score = static_cast<int>(key.getValue() & 0x3fff);
+        int depth = static_cast<int>((key.getValue() >> 16) & 0xff);
+        Move move(static_cast<unsigned int>((key.getValue() >> 24) & 0xfffffff));
+
+        TranspTableEntry entry;
+        if (sharedTt.probe(key, entry)) {
+          numHits++;
+          if (entry.getScore() != score || entry.getDepth() != depth || !(entry.getBestMove() == move)) {
+            numCorrupt++;
+          }
+        }
+        sharedTt.set(key, TranspTableEntry(score, depth, TranspTableEntry::EXACT, move));
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++) {
+      threads.push_back(std::thread(worker, i));
+    }
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+
+    REQUIRE(numHits > 0);
+    REQUIRE(numCorrupt == 0);
   }
 
   SECTION("Transposition tables are cleared when clear() is called") {
@@ -49,8 +147,9 @@ TEST_CASE("Transposition tables work as expected") {
     TranspTableEntry ttEntry(5, 5, TranspTableEntry::EXACT, move);
     tt.set(board.getZKey(), ttEntry);
 
-    REQUIRE(tt.getEntry(board.getZKey()) != nullptr);
+    TranspTableEntry entry;
+    REQUIRE(tt.probe(board.getZKey(), entry));
     tt.clear();
-    REQUIRE(tt.getEntry(board.getZKey()) == nullptr);
+    REQUIRE(!tt.probe(board.getZKey(), entry));
   }
 }
@@ -68,4 +68,36 @@ TEST_CASE("Boards update ZKeys correctly after moves") {
     board.setToFen("8/8/8/8/8/8/8/4K2n w - -");
     REQUIRE(board.getZKey().getValue() == initValue);
   }
+
+  SECTION("Pawn structure ZKeys are updated properly after pawn captures and promotions") {
+    board.setToFen("4k3/1P6/8/3p4/8/8/8/3QK3 w - -");
+
+    Move capture(d1, d5, QUEEN, Move::CAPTURE);
+    capture.setCapturedPieceType(PAWN);
+    board.doMove(capture);
+    board.doMove(Move(e8, f8, KING));
+
+    Move promotion(b7, b8, PAWN, Move::PROMOTION);
+    promotion.setPromotionPieceType(QUEEN);
+    board.doMove(promotion);
+
+    U64 initValue = board.getPawnStructureZKey().getValue();
+
+    board.setToFen("1Q3k2/8/8/3Q4/8/8/8/4K3 b - -");
+    REQUIRE(board.getPawnStructureZKey().getValue() == initValue);
+  }
+
+  SECTION("Material ZKeys only depend on the number of each piece") {
+    board.setToFen("4k3/1P6/8/3p4/8/8/8/3QK3 w - -");
+    U64 initValue = board.getMaterialZKey().getValue();
+
+    board.doMove(Move(d1, d4, QUEEN));
+    REQUIRE(board.getMaterialZKey().getValue() == initValue);
+
+    board.setToFen("3qk3/1P6/8/3p4/8/8/8/4K3 w - -");
+    REQUIRE(board.getMaterialZKey().getValue() != initValue);
+
+    board.setToFen("4k3/8/1P6/8/8/3p4/8/Q3K3 b - -");
+    REQUIRE(board.getMaterialZKey().getValue() == initValue);
+  }
 }